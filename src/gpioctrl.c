@@ -71,8 +71,9 @@ SOFTWARE.
     When the value of a variable associated with a hardware output pin is
     changed, that value (0 or 1) is written to the output pin.
 
-    Input pins can be monitored using a waiting task and when the input
-    pin changes state, the variable value is updated.
+    Input pins can be monitored for edge events and when the input
+    pin changes state, the variable value is updated.  The GPIO edge events
+    and the variable server signals are handled by a single event loop.
 
 */
 /*============================================================================*/
@@ -82,12 +83,25 @@ SOFTWARE.
 ==============================================================================*/
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <stdatomic.h>
+#include <limits.h>
 #include <unistd.h>
 #include <syslog.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
 #include <varserver/varserver.h>
 #include <tjson/json.h>
 #include <gpiod.h>
@@ -96,6 +110,263 @@ SOFTWARE.
         Private definitions
 ==============================================================================*/
 
+/*! number of nanoseconds in a second */
+#define NS_PER_SEC              ( 1000000000ULL )
+
+/*! number of nanoseconds in a millisecond */
+#define NS_PER_MS               ( 1000000ULL )
+
+/*! number of nanoseconds in a microsecond */
+#define NS_PER_US               ( 1000ULL )
+
+/*! default software PWM resolution in bits */
+#define PWM_DEFAULT_RESOLUTION  ( 8 )
+
+/*! maximum software PWM resolution in bits */
+#define PWM_MAX_RESOLUTION      ( 16 )
+
+/*! maximum number of steps in an output pattern */
+#define PATTERN_MAX_STEPS       ( 8 )
+
+/*! default software PWM period in nanoseconds ( 255 steps of 40us ) */
+#define PWM_DEFAULT_PERIOD_NS   ( 255ULL * 40000ULL )
+
+/*! default frequency measurement publish interval in nanoseconds */
+#define FREQUENCY_DEFAULT_INTERVAL_NS   ( 1000ULL * NS_PER_MS )
+
+/*! default pulse width publish interval in nanoseconds */
+#define PULSE_DEFAULT_INTERVAL_NS       ( 100ULL * NS_PER_MS )
+
+/*! maximum number of ready file descriptors handled per event loop wakeup */
+#define MAX_EPOLL_EVENTS        ( 32 )
+
+/*! maximum number of line events read per system call.  This is the
+ *  depth of the kernel line event FIFO */
+#define EVENT_BATCH_SIZE        ( 16 )
+
+/*! number of events which can be held for each quadrature encoder
+ *  channel while the other channel catches up */
+#define ENCODER_BUFFER_SIZE     ( 2 * EVENT_BATCH_SIZE )
+
+/*! maximum number of variable server signals read per system call */
+#define SIGNAL_BATCH_SIZE       ( 32 )
+
+/*! number of events kept in the event history of each input line.
+ *  This must be a power of two */
+#define HISTORY_SIZE            ( 64 )
+
+/*! mask applied to an event sequence number to index the event history */
+#define HISTORY_MASK            ( HISTORY_SIZE - 1 )
+
+/*! default location of the hardware PWM sysfs interface */
+#define PWM_SYSFS_ROOT          "/sys/class/pwm"
+
+/*! number of attempts to wait for an exported hardware PWM channel */
+#define PWM_EXPORT_RETRIES      ( 50 )
+
+/*! PWM backend types */
+typedef enum _pwm_backend
+{
+    /*! software PWM driven by the PWM scheduler */
+    PWM_BACKEND_SOFTWARE = 0,
+
+    /*! hardware PWM controller via the sysfs pwmchip interface */
+    PWM_BACKEND_HARDWARE,
+
+    /*! hardware PWM if available, otherwise software PWM */
+    PWM_BACKEND_AUTO
+
+} PWMBackend;
+
+/*! software PWM edges due within this many nanoseconds of each other
+ *  are applied together */
+#define PWM_TICK_NS             ( 20000ULL )
+
+/*! the _line_event structure is a GPIO line event normalized from
+ *  either of the kernel GPIO character device interfaces */
+typedef struct _line_event
+{
+    /*! CLOCK_MONOTONIC time of the event in nanoseconds */
+    uint64_t timestamp;
+
+    /*! level of the line after the event */
+    uint16_t level;
+
+} LineEvent;
+
+/*! the _history_entry structure is a line event recorded in the
+ *  event history of a GPIO line */
+typedef struct _history_entry
+{
+    /*! sequence number of the event on its line */
+    uint64_t seq;
+
+    /*! CLOCK_MONOTONIC time of the event in nanoseconds */
+    uint64_t timestamp;
+
+    /*! level of the line after the event */
+    uint16_t level;
+
+} HistoryEntry;
+
+/*! input line modes */
+typedef enum _input_mode
+{
+    /*! publish the level of the input */
+    INPUT_MODE_LEVEL = 0,
+
+    /*! count the edges on the input */
+    INPUT_MODE_COUNTER,
+
+    /*! measure the frequency or period of the input */
+    INPUT_MODE_FREQUENCY,
+
+    /*! one of the channels of a quadrature encoder */
+    INPUT_MODE_ENCODER,
+
+    /*! measure the pulse width of the input */
+    INPUT_MODE_PULSE_WIDTH
+
+} InputMode;
+
+/*! output line modes */
+typedef enum _output_mode
+{
+    /*! set the output to the level of the variable */
+    OUTPUT_MODE_LEVEL = 0,
+
+    /*! generate a pulse of the duration written to the variable */
+    OUTPUT_MODE_PULSE,
+
+    /*! repeat the pattern selected by the variable */
+    OUTPUT_MODE_PATTERN
+
+} OutputMode;
+
+/*! output pattern */
+typedef struct _output_pattern
+{
+    /*! name of the pattern */
+    const char *name;
+
+    /*! level of the output if the pattern has no steps */
+    int level;
+
+    /*! number of steps in the pattern */
+    size_t nSteps;
+
+    /*! duration of each step in milliseconds.  The output is active
+     *  during the even steps, and inactive during the odd steps */
+    uint16_t steps[PATTERN_MAX_STEPS];
+
+} OutputPattern;
+
+/*! pulse width measurements */
+typedef enum _pulse_measure
+{
+    /*! duty cycle in percent */
+    PULSE_MEASURE_DUTY = 0,
+
+    /*! high time in microseconds */
+    PULSE_MEASURE_HIGH,
+
+    /*! low time in microseconds */
+    PULSE_MEASURE_LOW
+
+} PulseMeasure;
+
+/*! quadrature decoder state table entry for an illegal transition */
+#define QUADRATURE_ILLEGAL      ( 2 )
+
+/*! the timer queue is defined below */
+struct _timer_queue;
+
+/*! timer index of a timer which is not queued */
+#define TIMER_IDLE              ( -1 )
+
+/*! timer index of an expired timer waiting for its handler to be invoked */
+#define TIMER_EXPIRED           ( -2 )
+
+/*! the quadrature encoder is defined below */
+struct _encoder;
+
+/*! the _timer structure is an entry in a timer queue.  Timers are
+ *  embedded in the objects they service and are ordered by expiry time */
+typedef struct _timer
+{
+    /*! absolute CLOCK_MONOTONIC expiry time in nanoseconds */
+    uint64_t due;
+
+    /*! position of the timer in the timer queue, TIMER_IDLE if not
+     *  queued, or TIMER_EXPIRED if its handler is pending */
+    int index;
+
+    /*! function to invoke when the timer expires */
+    void (*handler)( struct _timer_queue *pQueue,
+                     struct _timer *pTimer,
+                     uint64_t now );
+
+    /*! opaque argument for the timer handler */
+    void *arg;
+
+    /*! pointer to the next timer in a list of expired timers */
+    struct _timer *pNextExpired;
+
+} Timer;
+
+/*! the _timer_queue structure is a binary min-heap of timers
+ *  ordered by their expiry time */
+typedef struct _timer_queue
+{
+    /*! array of pointers to the queued timers */
+    Timer **pTimers;
+
+    /*! number of queued timers */
+    size_t n;
+
+    /*! number of timer slots allocated */
+    size_t size;
+
+    /*! opaque argument for the handlers of the queued timers */
+    void *arg;
+
+} TimerQueue;
+
+/*! the _line_bank structure manages a set of lines on the same chip
+ *  which are requested together, so their values can be written with
+ *  a single request */
+typedef struct _line_bank
+{
+    /*! pointer to the GPIO chip which owns the lines */
+    struct _gpio_chip *pGPIOChip;
+
+    /*! line request shared by all lines in the bank */
+    struct gpiod_line_request_config request;
+
+    /*! lines in the bank */
+    struct gpiod_line_bulk bulk;
+
+    /*! GPIO objects of the lines in the bank */
+    struct _gpio *pGPIOs[GPIOD_LINE_BULK_MAX_LINES];
+
+    /*! shadow of the line values */
+    int values[GPIOD_LINE_BULK_MAX_LINES];
+
+    /*! indicates the line values have changed and must be written */
+    bool dirty;
+
+    /*! indicates the lines in the bank were requested together */
+    bool requested;
+
+    /*! CLOCK_MONOTONIC time the line values were last read in
+     *  nanoseconds, or 0 if they have not been read */
+    uint64_t readTime;
+
+    /*! pointer to the next line bank */
+    struct _line_bank *pNext;
+
+} LineBank;
+
 /*! the _gpio structure manages the mapping between a gpiod_chip/gpiod_line
  *  and its associated variable */
 typedef struct _gpio
@@ -122,6 +393,154 @@ typedef struct _gpio
     /*! software PWM output */
     bool PWM;
 
+    /*! input mode */
+    InputMode inputMode;
+
+    /*! output mode */
+    OutputMode outputMode;
+
+    /*! type of the variable associated with the line */
+    VarType varType;
+
+    /*! number of edges counted on a counter input */
+    uint64_t count;
+
+    /*! publish the period in microseconds rather than the frequency in Hz */
+    bool measurePeriod;
+
+    /*! number of periods per frequency measurement.  0 measures all of
+     *  the periods in each publish interval */
+    uint64_t freqPeriods;
+
+    /*! time without edges after which the frequency is 0 Hz,
+     *  in nanoseconds */
+    uint64_t freqTimeout;
+
+    /*! timestamp of the first edge of the current measurement */
+    uint64_t freqFirst;
+
+    /*! timestamp of the most recent edge */
+    uint64_t freqLast;
+
+    /*! number of edges in the current measurement */
+    uint64_t freqEdges;
+
+    /*! most recently measured frequency in Hz */
+    double frequency;
+
+    /*! timer used to publish the frequency at a fixed rate */
+    Timer freqTimer;
+
+    /*! pointer to the quadrature encoder this line is a channel of */
+    struct _encoder *pEncoder;
+
+    /*! pointer to the line group this line is a member of */
+    struct _line_group *pGroup;
+
+    /*! bit of the line group value which this line carries */
+    int groupBit;
+
+    /*! pulse width measurement published to the variable */
+    PulseMeasure pulseMeasure;
+
+    /*! number of cycles averaged in each pulse width measurement */
+    uint64_t pulseCycles;
+
+    /*! timestamp of the most recent rising edge */
+    uint64_t pulseRise;
+
+    /*! timestamp of the most recent falling edge */
+    uint64_t pulseFall;
+
+    /*! sum of the high times of the current measurement */
+    uint64_t pulseHighSum;
+
+    /*! sum of the low times of the current measurement */
+    uint64_t pulseLowSum;
+
+    /*! number of cycles in the current measurement */
+    uint64_t pulseCount;
+
+    /*! average high time of the last measurement in nanoseconds */
+    uint64_t pulseHigh;
+
+    /*! average low time of the last measurement in nanoseconds */
+    uint64_t pulseLow;
+
+    /*! software PWM value handed from the main thread to the
+     *  PWM scheduler thread */
+    atomic_int pwmValue;
+
+    /*! software PWM edge timer */
+    Timer pwmTimer;
+
+    /*! start time of the current software PWM period in nanoseconds */
+    uint64_t pwmPeriodStart;
+
+    /*! current software PWM output level */
+    int pwmLevel;
+
+    /*! indicates the next software PWM edge is the falling edge */
+    bool pwmFalling;
+
+    /*! software PWM period in nanoseconds */
+    uint64_t pwmPeriod;
+
+    /*! software PWM resolution in bits */
+    int pwmResolution;
+
+    /*! software PWM full scale value */
+    int pwmMax;
+
+    /*! number of software PWM periods started.  This and the following
+     *  statistics are written by the PWM scheduler thread and read by
+     *  the main thread */
+    _Atomic uint64_t pwmCycles;
+
+    /*! time the first software PWM period was started */
+    _Atomic uint64_t pwmFirstStart;
+
+    /*! time the most recent software PWM period was started */
+    _Atomic uint64_t pwmLastStart;
+
+    /*! sum of the software PWM edge latencies in nanoseconds */
+    _Atomic uint64_t pwmLatencySum;
+
+    /*! maximum software PWM edge latency in nanoseconds */
+    _Atomic uint64_t pwmLatencyMax;
+
+    /*! number of software PWM edges processed */
+    _Atomic uint64_t pwmEdges;
+
+    /*! number of software PWM periods which were re-aligned because
+     *  the scheduler fell more than a full period behind */
+    _Atomic uint64_t pwmOverruns;
+
+    /*! requested PWM backend */
+    PWMBackend pwmBackend;
+
+    /*! hardware PWM chip number */
+    int pwmChip;
+
+    /*! hardware PWM channel number */
+    int pwmChannel;
+
+    /*! file descriptor of the hardware PWM duty_cycle attribute */
+    int pwmDutyFd;
+
+    /*! indicates the line is driven by a hardware PWM controller */
+    bool pwmHardware;
+
+    /*! pointer to the line bank this line was requested in */
+    LineBank *pBank;
+
+    /*! index of this line in its line bank */
+    int bankIndex;
+
+    /*! indicates the line could not be requested, so it is not read
+     *  or written */
+    bool unusable;
+
     /*! event type.  one of:
         0
         GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE
@@ -129,6 +548,98 @@ typedef struct _gpio
         GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES */
     int event_type;
 
+    /*! publish every event read from the line, rather than only the
+     *  final state after each batch of events */
+    bool publishAll;
+
+    /*! CLOCK_MONOTONIC time of the event which produced the current
+     *  value in nanoseconds */
+    uint64_t timestamp;
+
+    /*! handle to the variable which receives the event timestamps,
+     *  or VAR_INVALID if event timestamps are not published */
+    VAR_HANDLE hTimestampVar;
+
+    /*! clock used for the published event timestamps.  One of:
+        CLOCK_MONOTONIC
+        CLOCK_REALTIME */
+    clockid_t timestampClock;
+
+    /*! indicates the kernel stamps the line events with the realtime
+     *  clock, so their timestamps are published without conversion */
+    bool realtimeEvents;
+
+    /*! minimum interval between variable updates in nanoseconds.
+     *  0 publishes every update immediately */
+    uint64_t publishInterval;
+
+    /*! time of the last variable update in nanoseconds */
+    uint64_t lastPublish;
+
+    /*! timer used to flush a coalesced variable update */
+    Timer publishTimer;
+
+    /*! time the input level must be stable before it is published,
+     *  in nanoseconds.  0 disables the debounce filter */
+    uint64_t debounceInterval;
+
+    /*! input event waiting for the debounce interval to elapse */
+    LineEvent debounceEvent;
+
+    /*! timer used to detect when the input level has settled */
+    Timer debounceTimer;
+
+    /*! indicates the input is debounced by the kernel */
+    bool kernelDebounce;
+
+    /*! file descriptor of a line requested with the GPIO v2 uAPI,
+     *  or -1 if the line was requested with libgpiod */
+    int lineFd;
+
+    /*! length of one unit of a pulse output duration in nanoseconds */
+    uint64_t oneShotUnit;
+
+    /*! indicates a retriggered pulse output is extended by the new
+     *  duration, rather than restarted */
+    bool oneShotExtend;
+
+    /*! CLOCK_MONOTONIC time the active pulse output ends in nanoseconds */
+    uint64_t oneShotEnd;
+
+    /*! timer used to end a pulse output */
+    Timer oneShotTimer;
+
+    /*! pattern selected on a pattern output */
+    const OutputPattern *pPattern;
+
+    /*! current step of the output pattern */
+    size_t patternStep;
+
+    /*! timer used to step through the output pattern */
+    Timer patternTimer;
+
+    /*! write every output update to the hardware, even if the output
+     *  is already at the requested value */
+    bool forceWrite;
+
+    /*! maximum age of a cached polled input level in nanoseconds.
+     *  0 reads the input on every request */
+    uint64_t maxAge;
+
+    /*! indicates the polled input has a request waiting to be read */
+    bool pollPending;
+
+    /*! pointer to the next polled input waiting to be read */
+    struct _gpio *pNextPoll;
+
+    /*! ring of the most recent events read from the line, indexed by
+     *  the event sequence number masked with HISTORY_MASK.  This is only
+     *  allocated for lines which generate events */
+    HistoryEntry *pHistory;
+
+    /*! sequence number of the next event recorded in the history */
+    uint64_t historySeq;
+
     /*! line request */
     struct gpiod_line_request_config request;
 
@@ -158,15 +669,138 @@ typedef struct _gpio_chip
     struct _gpio_chip *pNext;
 } GPIOChip;
 
+/*! the _encoder_channel structure holds the events read from one
+ *  channel of a quadrature encoder until they can be decoded in
+ *  timestamp order with the events of the other channel */
+typedef struct _encoder_channel
+{
+    /*! events waiting to be decoded, in timestamp order */
+    LineEvent events[ENCODER_BUFFER_SIZE];
+
+    /*! number of events waiting to be decoded */
+    int n;
+
+    /*! indicates the channel event queue was drained by the last read */
+    bool drained;
+
+} EncoderChannel;
+
+/*! the _encoder structure decodes a quadrature encoder connected
+ *  to a pair of input lines */
+typedef struct _encoder
+{
+    /*! encoder channel A */
+    GPIO *pA;
+
+    /*! encoder channel B */
+    GPIO *pB;
+
+    /*! events read from channel A which have not been decoded */
+    EncoderChannel chA;
+
+    /*! events read from channel B which have not been decoded */
+    EncoderChannel chB;
+
+    /*! current encoder state ( A << 1 ) | B */
+    int state;
+
+    /*! accumulated encoder position */
+    int64_t position;
+
+    /*! number of events which were not a legal quadrature transition */
+    uint64_t illegal;
+
+    /*! number of event read errors */
+    uint64_t errors;
+
+    /*! pointer to the next encoder */
+    struct _encoder *pNext;
+
+} Encoder;
+
+/*! the _line_group structure maps a single variable to an ordered group
+ *  of lines on the same chip, which are requested and accessed together.
+ *  The first line in the group carries the least significant bit of the
+ *  variable value */
+typedef struct _line_group
+{
+    /*! handle to the group variable */
+    VAR_HANDLE hVar;
+
+    /*! name of the group variable */
+    char *name;
+
+    /*! type of the group variable */
+    VarType varType;
+
+    /*! direction of the group lines */
+    int direction;
+
+    /*! pointer to the GPIO chip which owns the lines */
+    GPIOChip *pGPIOChip;
+
+    /*! group lines, in bit order */
+    GPIO *pLines[GPIOD_LINE_BULK_MAX_LINES];
+
+    /*! number of lines in the group */
+    int nLines;
+
+    /*! line bank the group lines are requested in */
+    LineBank *pBank;
+
+    /*! current group value */
+    uint64_t value;
+
+    /*! indicates the group value may not match the hardware */
+    bool stale;
+
+    /*! pointer to the next line group */
+    struct _line_group *pNext;
+
+} LineGroup;
+
+/*! GPIO controller statistics */
+typedef struct _gpioctrl_stats
+{
+    /*! number of line event read system calls */
+    uint64_t eventReads;
+
+    /*! number of line events read */
+    uint64_t events;
+
+    /*! number of variable updates written */
+    uint64_t updates;
+
+    /*! number of variable updates superseded before they were written */
+    uint64_t coalesced;
+
+    /*! number of line events discarded by the debounce filter */
+    uint64_t debounced;
+
+    /*! number of polled input requests */
+    uint64_t polls;
+
+    /*! number of polled input requests served from the cached level */
+    uint64_t pollHits;
+
+    /*! number of polled input line bank reads */
+    uint64_t pollReads;
+
+    /*! number of output updates written to the hardware */
+    uint64_t writesIssued;
+
+    /*! number of output updates skipped because the output was
+     *  already at the requested value */
+    uint64_t writesSuppressed;
+
+} GPIOCtrlStats;
+
 /*! GPIO controller state */
 typedef struct _gpioctrl_state
 {
     /*! service name */
     char *service;
 
-    /*! operating mode */
-    bool gpiowatch;
-
     /*! variable server handle */
     VARSERVER_HANDLE hVarServer;
 
@@ -176,6 +810,9 @@ typedef struct _gpioctrl_state
     /*! name of the GPIO definition file */
     char *pFileName;
 
+    /*! location of the hardware PWM sysfs interface */
+    char *pPWMSysfs;
+
     /*! flag to indicate the GPIO controller is running */
     bool running;
 
@@ -188,8 +825,91 @@ typedef struct _gpioctrl_state
     /*! pointer to the current gpiochip we are parsing */
     struct gpiod_chip *pChip;
 
-    /*! bulk lines array for event monitoring */
-    struct gpiod_line_bulk monitoredLines;
+    /*! event loop epoll file descriptor */
+    int epfd;
+
+    /*! signal file descriptor for variable server signals */
+    int sigfd;
+
+    /*! buffer for reading variable server signals */
+    struct signalfd_siginfo sigInfo[SIGNAL_BATCH_SIZE];
+
+    /*! pointer to the first polled input waiting to be read */
+    GPIO *pFirstPoll;
+
+    /*! timer file descriptor for the event loop timers */
+    int timerfd;
+
+    /*! expiry time the event loop timer file descriptor is armed for */
+    uint64_t timerDue;
+
+    /*! event loop timers */
+    TimerQueue eventQueue;
+
+    /*! buffer for reading libgpiod line events */
+    struct gpiod_line_event events[EVENT_BATCH_SIZE];
+
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    /*! buffer for reading GPIO v2 uAPI line events */
+    struct gpio_v2_line_event v2events[EVENT_BATCH_SIZE];
+#endif
+
+    /*! normalized line events */
+    LineEvent lineEvents[EVENT_BATCH_SIZE];
+
+    /*! pointer to the first quadrature encoder */
+    Encoder *pFirstEncoder;
+
+    /*! pointer to the first line group */
+    LineGroup *pFirstGroup;
+
+    /*! handle to the info variable */
+    VAR_HANDLE hInfo;
+
+    /*! handle to the statistics variable */
+    VAR_HANDLE hStats;
+
+    /*! handle to the event history variable */
+    VAR_HANDLE hHistory;
+
+    /*! GPIO controller statistics */
+    GPIOCtrlStats stats;
+
+    /*! dispatch table mapping variable handles to GPIO lines */
+    GPIO **pGPIOTable;
+
+    /*! number of entries in the dispatch table */
+    size_t nGPIOTable;
+
+    /*! reverse index mapping line event file descriptors to GPIO lines */
+    GPIO **pEventTable;
+
+    /*! number of entries in the reverse index */
+    size_t nEventTable;
+
+    /*! software PWM edge schedule */
+    TimerQueue pwmQueue;
+
+    /*! software PWM scheduler thread */
+    pthread_t pwmThread;
+
+    /*! indicates the software PWM scheduler thread is running.  It is
+     *  cleared by the main thread to stop the scheduler thread */
+    atomic_bool pwmRunning;
+
+    /*! mutex held by the software PWM scheduler thread except while
+     *  it is waiting for the next edge */
+    pthread_mutex_t pwmLock;
+
+    /*! condition variable used to wake the software PWM scheduler
+     *  thread when it is stopped.  It waits on CLOCK_MONOTONIC */
+    pthread_cond_t pwmWake;
+
+    /*! pointer to the first bank of software PWM lines */
+    LineBank *pFirstPWMBank;
+
+    /*! pointer to the first bank of polled input lines */
+    LineBank *pFirstInputBank;
 
 } GPIOCtrlState;
 
@@ -200,6 +920,19 @@ typedef struct _gpioctrl_state
 /*! GPIO Controller State object */
 GPIOCtrlState state;
 
+/*! output patterns, indexed by the value of a pattern output variable */
+static const OutputPattern patterns[] =
+{
+    { "off", 0, 0, { 0 } },
+    { "on", 1, 0, { 0 } },
+    { "slow_blink", 0, 2, { 500, 500 } },
+    { "fast_blink", 0, 2, { 100, 100 } },
+    { "heartbeat", 0, 4, { 100, 100, 100, 700 } },
+    { "flash_1", 0, 2, { 150, 1850 } },
+    { "flash_2", 0, 4, { 150, 250, 150, 1450 } },
+    { "flash_3", 0, 6, { 150, 250, 150, 250, 150, 1050 } }
+};
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
@@ -216,32 +949,171 @@ static GPIOChip *CreateChip( JNode *pNode, GPIOCtrlState *pState );
 static int CreateLines( JNode *pNode, GPIOCtrlState *pState );
 static int ParseLine( JNode *pNode, void *arg );
 static GPIO *CreateLine( JNode *pNode, GPIOCtrlState *pState );
+static GPIO *AddLine( GPIOChip *pGPIOChip,
+                      unsigned int line_num,
+                      VAR_HANDLE hVar,
+                      char *varname );
+static void RemoveLine( GPIOCtrlState *pState,
+                        GPIOChip *pGPIOChip,
+                        GPIO *pGPIO );
+static int CreateEncoders( JNode *pNode, GPIOCtrlState *pState );
+static int ParseEncoder( JNode *pNode, void *arg );
+static GPIO *CreateEncoderLine( JNode *pNode,
+                                char *channel,
+                                Encoder *pEncoder,
+                                VAR_HANDLE hVar,
+                                char *varname,
+                                GPIOCtrlState *pState );
+static int CreateGroups( JNode *pNode, GPIOCtrlState *pState );
+static int ParseGroup( JNode *pNode, void *arg );
+static int ParseGroupLine( JNode *pNode, void *arg );
+static int RequestGroup( GPIOCtrlState *pState,
+                         LineGroup *pGroup,
+                         JNode *pNode );
+static void DiscardGroup( GPIOCtrlState *pState, LineGroup *pGroup );
+static int UpdateGroupOutput( GPIOCtrlState *pState, LineGroup *pGroup );
+static int StartOneShot( GPIOCtrlState *pState, GPIO *pGPIO );
+static void OneShotTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now );
+static int StartPattern( GPIOCtrlState *pState, GPIO *pGPIO );
+static void PatternTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now );
+static int WriteGroup( LineGroup *pGroup );
+static int UpdateGroupInput( GPIOCtrlState *pState, LineGroup *pGroup );
+static int ReadGroup( LineGroup *pGroup );
+static int HandleGroupEvent( GPIOCtrlState *pState, GPIO *pGPIO );
 static VAR_HANDLE GetVarHandle( VARSERVER_HANDLE hVarServer,
                                 JNode *pNode,
                                 char **ppName );
 static int ParseLineDirection( GPIO *pGPIO,
                                JNode *pNode,
                                GPIOCtrlState *pState );
+static int ParseLinePWM( GPIO *pGPIO, JNode *pNode );
 static int ParseLineActiveState( GPIO *pGPIO, JNode *pNode );
 static int ParseLineBias( GPIO *pGPIO, JNode *pNode );
 static int ParseLineDrive( GPIO *pGPIO, JNode *pNode );
+static int ParseLineForceWrite( GPIO *pGPIO, JNode *pNode );
 static int ParseLineEvent( GPIO *pGPIO, JNode *pNode );
+static int ParseLinePublish( GPIO *pGPIO, JNode *pNode );
+static int ParseLineDebounce( GPIO *pGPIO, JNode *pNode );
+static int ParseLineMaxAge( GPIO *pGPIO, JNode *pNode );
+static int ParseLineTimestamp( GPIO *pGPIO,
+                               JNode *pNode,
+                               GPIOCtrlState *pState );
+static int ParseLineFrequency( GPIO *pGPIO,
+                               JNode *pNode,
+                               GPIOCtrlState *pState );
+static int ParseLinePulse( GPIO *pGPIO, JNode *pNode );
+static int ParseLineOneShot( GPIO *pGPIO, JNode *pNode );
+static int BuildGPIOTable( GPIOCtrlState *pState );
 static GPIO *FindGPIO( GPIOCtrlState *pState, VAR_HANDLE hVar );
-static VAR_HANDLE FindVar( GPIOCtrlState *pState, struct gpiod_line *pLine );
+static GPIO *SearchGPIO( GPIOCtrlState *pState, VAR_HANDLE hVar );
+static int AddEventIndex( GPIOCtrlState *pState, GPIO *pGPIO );
+static GPIO *FindEventGPIO( GPIOCtrlState *pState, int fd );
 static int UpdateOutput( VAR_HANDLE hVar, GPIOCtrlState *pState );
 static int UpdateInput( VAR_HANDLE hVar, GPIOCtrlState *pState );
+static int QueuePolledInput( GPIOCtrlState *pState, int sig, int sigval );
+static int FlushPolledInputs( GPIOCtrlState *pState );
+static int UpdatePolledInput( GPIOCtrlState *pState,
+                              GPIO *pGPIO,
+                              uint64_t now );
+static int ReadPolledInput( GPIOCtrlState *pState,
+                            GPIO *pGPIO,
+                            uint64_t now );
 static int run( GPIOCtrlState *pState );
-static int WaitVarSignal( GPIOCtrlState *pState );
-static int WaitGPIOEvent( GPIOCtrlState *pState );
-static int HandleGPIOEvent( GPIOCtrlState *pState, struct gpiod_line *pLine );
+static int SetupVarSignals( GPIOCtrlState *pState );
+static int SetupEventLoop( GPIOCtrlState *pState );
+static int WaitEvents( GPIOCtrlState *pState );
+static int HandleVarSignals( GPIOCtrlState *pState );
+static int HandleVarSignal( GPIOCtrlState *pState, int sig, int sigval );
+static int HandleGPIOEvent( GPIOCtrlState *pState, GPIO *pGPIO );
+static int ReadLineEvents( GPIOCtrlState *pState, GPIO *pGPIO );
+static void RecordHistory( GPIO *pGPIO, LineEvent *pEvents, int n );
+static int ReadLineLevel( GPIO *pGPIO );
+static int HandleEncoderEvent( GPIOCtrlState *pState, Encoder *pEncoder );
+static int ReadEncoderChannel( GPIOCtrlState *pState,
+                               Encoder *pEncoder,
+                               GPIO *pGPIO,
+                               EncoderChannel *pChannel );
+static void DecodeEncoderEvents( GPIOCtrlState *pState,
+                                 Encoder *pEncoder,
+                                 uint64_t limit );
+static void DecodeQuadrature( Encoder *pEncoder,
+                              GPIO *pGPIO,
+                              LineEvent *pEvent );
+static int PublishValue( GPIOCtrlState *pState,
+                         GPIO *pGPIO,
+                         uint16_t value,
+                         uint64_t timestamp );
+static int PublishLine( GPIOCtrlState *pState, GPIO *pGPIO );
+static int WriteLineVar( GPIOCtrlState *pState, GPIO *pGPIO );
+static VarType GetVarType( GPIOCtrlState *pState, VAR_HANDLE hVar );
+static int GetVarInteger( GPIOCtrlState *pState,
+                          VAR_HANDLE hVar,
+                          uint64_t *pValue );
+static int SetVarValue( GPIOCtrlState *pState,
+                        VAR_HANDLE hVar,
+                        VarType type,
+                        uint64_t value );
+static int SetVarDouble( GPIOCtrlState *pState,
+                         VAR_HANDLE hVar,
+                         VarType type,
+                         double value );
+static void MeasureEdge( GPIO *pGPIO, uint64_t timestamp );
+static bool MeasurePulse( GPIO *pGPIO, LineEvent *pEvent );
+static void MeasureFrequency( GPIO *pGPIO );
+static void FrequencyTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now );
+static int WriteTimestampVar( GPIOCtrlState *pState, GPIO *pGPIO );
+static void PublishTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now );
+static int DebounceEvent( GPIOCtrlState *pState,
+                          GPIO *pGPIO,
+                          LineEvent *pEvent,
+                          bool *pPublish );
+static bool SettleEvent( GPIOCtrlState *pState, GPIO *pGPIO );
+static void DebounceTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now );
+static int ArmEventTimer( GPIOCtrlState *pState );
 static int RequestLine( GPIO *pGPIO, GPIOCtrlState *pState );
+static int RequestLineV2( GPIO *pGPIO, GPIOCtrlState *pState );
+static bool KernelRealtime( GPIO *pGPIO );
 static int SetupNotification( GPIO *pGPIO, GPIOCtrlState *pState );
 static int SetupPrintNotifications( GPIOCtrlState *pState );
+static int SetupPrintNotification( GPIOCtrlState *pState,
+                                   char *name,
+                                   VAR_HANDLE *phVar );
 static int PrintStatus( GPIOCtrlState *pState, int fd );
+static int PrintStats( GPIOCtrlState *pState, int fd );
+static int PrintHistory( GPIOCtrlState *pState, int fd );
+static int PrintLineHistory( GPIO *pGPIO, int fd );
 static int PrintLineInfo( GPIOCtrlState *pState, GPIO *pGPIO, int fd );
+static int PrintPWMInfo( GPIO *pGPIO, int fd );
 static void Shutdown( GPIOCtrlState *pState );
-static int CreatePWM( GPIO *pGPIO );
+static int CreatePWM( GPIOCtrlState *pState, GPIO *pGPIO );
+static int StartPWMScheduler( GPIOCtrlState *pState );
+static void StopPWMScheduler( GPIOCtrlState *pState );
 static void *PWMThread( void *arg );
+static void PWMEdge( TimerQueue *pQueue, Timer *pTimer, uint64_t now );
+static int CreateHardwarePWM( GPIOCtrlState *pState, GPIO *pGPIO );
+static int SetHardwarePWM( GPIO *pGPIO );
+static int WriteSysfs( const char *dir, const char *attr, const char *value );
+static int AddBankLine( LineBank **ppFirstBank,
+                        GPIOChip *pGPIOChip,
+                        GPIO *pGPIO );
+static int RequestBanks( LineBank *pFirstBank );
+static int WriteBanks( LineBank *pFirstBank );
+static int ReadBank( LineBank *pBank, uint64_t now );
+static void FreeBanks( LineBank **ppFirstBank );
+static uint64_t GetMonotonicTime( void );
+static void TimerInit( Timer *pTimer,
+                       void (*handler)( TimerQueue *pQueue,
+                                        Timer *pTimer,
+                                        uint64_t now ),
+                       void *arg );
+static int TimerStart( TimerQueue *pQueue, Timer *pTimer, uint64_t due );
+static void TimerStop( TimerQueue *pQueue, Timer *pTimer );
+static Timer *TimerNext( TimerQueue *pQueue );
+static Timer *TimerExpire( TimerQueue *pQueue, uint64_t limit );
+static void TimerDispatch( TimerQueue *pQueue, uint64_t now, uint64_t limit );
+static void TimerSiftUp( TimerQueue *pQueue, size_t i );
+static void TimerSiftDown( TimerQueue *pQueue, size_t i );
+static void TimerSwap( TimerQueue *pQueue, size_t i, size_t j );
 
 /*==============================================================================
         Private function definitions
@@ -275,6 +1147,11 @@ void main(int argc, char **argv)
 
     /* clear the gpioctrl state object */
     memset( &state, 0, sizeof( state ) );
+    state.epfd = -1;
+    state.sigfd = -1;
+    state.timerfd = -1;
+    state.eventQueue.arg = &state;
+    state.pwmQueue.arg = &state;
 
     if( argc < 2 )
     {
@@ -283,15 +1160,14 @@ void main(int argc, char **argv)
     }
 
     state.service = strdup( argv[0] );
-
-    if (strcmp( state.service, "gpiowatch" ) == 0 )
-    {
-        state.gpiowatch = true;
-    }
+    state.pPWMSysfs = PWM_SYSFS_ROOT;
 
     /* set up an abnormal termination handler */
     SetupTerminationHandler();
 
+    /* receive the variable server signals via a signal file descriptor */
+    SetupVarSignals( &state );
+
     /* process the command line options */
     ProcessOptions( argc, argv, &state );
 
@@ -317,9 +1193,21 @@ void main(int argc, char **argv)
         /* set up the file vars by iterating through the configuration array */
         JSON_Iterate( gpiodef, ParseChip, (void *)&state );
 
+        /* build the variable handle to GPIO line dispatch table */
+        BuildGPIOTable( &state );
+
+        /* request the polled input lines */
+        RequestBanks( state.pFirstInputBank );
+
+        /* start the software PWM scheduler */
+        StartPWMScheduler( &state );
+
         /* run the GPIO controller */
         run( &state );
 
+        /* stop the software PWM scheduler */
+        StopPWMScheduler( &state );
+
         /* shut down the reserved GPIO lines */
         Shutdown( &state );
 
@@ -334,11 +1222,9 @@ void main(int argc, char **argv)
     Run the GPIO controller
 
     The run function loops forever waiting for signals from the
-    variable server or events from the GPIO library and acting on them.
-    The operating mode (signals or events) is determined based on the
-    value of the gpiowatch variable:
-        true => wait gpio events
-        false => wait varserver signals
+    variable server and events from the GPIO library and acting on them.
+    Both are multiplexed in a single event loop, so GPIO input events
+    and variable server requests are handled by the same process.
 
     @param[in]
         pState
@@ -346,6 +1232,7 @@ void main(int argc, char **argv)
 
     @retval EOK the GPIO controller completed successfully
     @retval EINVAL invalid arguments
+    @retval other error setting up the event loop
 
 ==============================================================================*/
 static int run( GPIOCtrlState *pState )
@@ -354,19 +1241,18 @@ static int run( GPIOCtrlState *pState )
 
     if ( pState != NULL )
     {
-        result = EOK;
+        /* set up the event loop */
+        result = SetupEventLoop( pState );
+        if ( result == EOK )
+        {
+            pState->running = true;
 
-        pState->running = true;
+            /* wait for the first event loop timer */
+            ArmEventTimer( pState );
 
-        while( pState->running == true )
-        {
-            if( pState->gpiowatch == true )
-            {
-                WaitGPIOEvent( pState );
-            }
-            else
+            while( pState->running == true )
             {
-                WaitVarSignal( pState );
+                WaitEvents( pState );
             }
         }
     }
@@ -374,113 +1260,137 @@ static int run( GPIOCtrlState *pState )
     return result;
 }
 
-/*==========================================================================*/
-/*  WaitGPIOEvent                                                           */
+/*============================================================================*/
+/*  SetupVarSignals                                                           */
 /*!
-    Wait for GPIO events
-
-    The WaitGPIOEvent function waits for a GPIO rising or falling
-    edge event.
+    Set up the variable server signal file descriptor
+
+    The SetupVarSignals function blocks the variable server signals
+    and creates a signal file descriptor to receive them, so they can be
+    waited for in the event loop along with the GPIO events.
+    Only the signals for the notifications which are requested are
+    blocked.  Validation notifications are never requested, so
+    SIG_VAR_VALIDATE keeps its default disposition.
+    The signals must be blocked before any notifications are requested
+    from the variable server, and before any threads are created,
+    so they are never delivered asynchronously.
 
     @param[in]
         pState
             pointer to the GPIO controller state object
 
-    @retval EOK the event was handled successfully
+    @retval EOK the signal file descriptor was created
     @retval EINVAL invalid arguments
+    @retval other error returned by signalfd
 
 ==============================================================================*/
-static int WaitGPIOEvent( GPIOCtrlState *pState )
+static int SetupVarSignals( GPIOCtrlState *pState )
 {
     int result = EINVAL;
-    int rc;
-    int i;
-    struct gpiod_line_bulk events;
+    sigset_t mask;
 
     if ( pState != NULL )
     {
-        rc = gpiod_line_event_wait_bulk( &pState->monitoredLines,
-                                         NULL,
-                                         &events );
-        if ( rc < 0 )
-        {
-            result = errno;
-        }
-        else if ( rc > 0 )
-        {
-            for( i = 0; i < events.num_lines; i++ )
-            {
-                /* handle the line state update */
-                HandleGPIOEvent( pState, events.lines[i] );
-            }
-        }
+        sigemptyset( &mask );
+        sigaddset( &mask, SIG_VAR_MODIFIED );
+        sigaddset( &mask, SIG_VAR_CALC );
+        sigaddset( &mask, SIG_VAR_PRINT );
+        sigprocmask( SIG_BLOCK, &mask, NULL );
+
+        pState->sigfd = signalfd( -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC );
+        result = ( pState->sigfd != -1 ) ? EOK : errno;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  HandleGPIOEvent                                                           */
+/*  SetupEventLoop                                                            */
 /*!
-    Handle a GPIO input event
+    Set up the event loop
 
-    The HandleGPIOEvent function processes a single gpio event
-    ( low to high, or high to low transition on an input pin )
-    The function searches for system variable that the line is
-    associated with, and sets its value to 0 or 1 depending on
-    if the transition was high to low, or low to high.
+    The SetupEventLoop function creates the epoll instance used by the
+    event loop, and adds the variable server signal file descriptor,
+    the event loop timer file descriptor, and the event file descriptors
+    of all of the monitored GPIO lines to it.  There is no limit on the
+    number of monitored GPIO lines other than the process file
+    descriptor limit.
 
     @param[in]
         pState
             pointer to the GPIO controller state object
 
-    @param[in]
-        pLine
-            pointer to the gpiod_line object associated with the event
-
-    @retval EOK the event was handled successfully
-    @retval other error reported by VAR_Set()
+    @retval EOK the event loop was set up
     @retval EINVAL invalid arguments
+    @retval other error returned by epoll
 
 ==============================================================================*/
-static int HandleGPIOEvent( GPIOCtrlState *pState, struct gpiod_line *pLine )
+static int SetupEventLoop( GPIOCtrlState *pState )
 {
     int result = EINVAL;
-    struct gpiod_line_event event;
-    VAR_HANDLE hVar;
-    VarObject var;
-    uint16_t val;
+    struct epoll_event ev;
+    int fd;
 
     if ( ( pState != NULL ) &&
-         ( pLine != NULL ) )
+         ( pState->sigfd != -1 ) )
     {
-        /* determine the type of event that occurred */
-        if ( gpiod_line_event_read( pLine, &event ) == 0 )
+        pState->epfd = epoll_create1( EPOLL_CLOEXEC );
+        if ( pState->epfd != -1 )
         {
-            val = ( event.event_type == GPIOD_LINE_EVENT_RISING_EDGE ) ? 1 : 0;
+            result = EOK;
 
-            /* find the variable associated with the gpiod line */
-            hVar = FindVar( pState, pLine );
-            if ( hVar != VAR_INVALID )
+            /* wait for variable server signals */
+            memset( &ev, 0, sizeof( ev ) );
+            ev.events = EPOLLIN;
+            ev.data.fd = pState->sigfd;
+            if ( epoll_ctl( pState->epfd,
+                            EPOLL_CTL_ADD,
+                            pState->sigfd,
+                            &ev ) != 0 )
             {
-                /* set the value of the variable */
-                var.val.ui = val;
-                var.type = VARTYPE_UINT16;
-                var.len = sizeof(uint16_t);
+                result = errno;
+            }
 
-                /* write to the variable */
-                result = VAR_Set( pState->hVarServer,
-                                  hVar,
-                                  &var );
+            /* wait for the event loop timers */
+            pState->timerfd = timerfd_create( CLOCK_MONOTONIC,
+                                              TFD_NONBLOCK | TFD_CLOEXEC );
+            if ( pState->timerfd != -1 )
+            {
+                ev.events = EPOLLIN;
+                ev.data.fd = pState->timerfd;
+                if ( epoll_ctl( pState->epfd,
+                                EPOLL_CTL_ADD,
+                                pState->timerfd,
+                                &ev ) != 0 )
+                {
+                    result = errno;
+                }
             }
             else
             {
-                result = ENOENT;
+                result = errno;
+            }
+
+            /* wait for GPIO line events on every indexed line */
+            for ( fd = 0; (size_t)fd < pState->nEventTable; fd++ )
+            {
+                if ( pState->pEventTable[fd] != NULL )
+                {
+                    ev.events = EPOLLIN;
+                    ev.data.fd = fd;
+                    if ( epoll_ctl( pState->epfd,
+                                    EPOLL_CTL_ADD,
+                                    fd,
+                                    &ev ) != 0 )
+                    {
+                        result = errno;
+                    }
+                }
             }
         }
         else
         {
-            result = EIO;
+            result = errno;
         }
     }
 
@@ -488,423 +1398,603 @@ static int HandleGPIOEvent( GPIOCtrlState *pState, struct gpiod_line *pLine )
 }
 
 /*============================================================================*/
-/*  WaitVarSignal                                                             */
+/*  WaitEvents                                                                */
 /*!
-    Wait for signals from the variable server
+    Wait for events
 
-    The WaitVarSignal function waits for a signal from the variable server
-    such as one of the following:
-        - SIG_VAR_MODIFIED
-        - SIG_VAR_CALC
-        - SIG_VAR_PRINT
+    The WaitEvents function waits for variable server signals, GPIO
+    rising or falling edge events, and event loop timers, and dispatches
+    all of the events which are ready to their handlers.  Once the events
+    have been handled, all of the expired event loop timers are processed
+    and the timer file descriptor is re-armed for the next timer.
 
     @param[in]
         pState
             pointer to the GPIO controller state object
 
-    @retval EOK the signal was handled successfully
-    @retval ENOTSUP the signal was not supported
+    @retval EOK the events were handled successfully
     @retval EINVAL invalid arguments
+    @retval other error returned by epoll_wait
 
 ==============================================================================*/
-static int WaitVarSignal( GPIOCtrlState *pState )
+static int WaitEvents( GPIOCtrlState *pState )
 {
-    int sig;
-    int sigval;
-    VAR_HANDLE hVar;
-    int fd = -1;
     int result = EINVAL;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    GPIO *pGPIO;
+    uint64_t expirations;
+    uint64_t now;
+    int n;
+    int i;
+    int fd;
 
     if ( pState != NULL )
     {
-        /* wait for a signal from the variable server */
-        sig = VARSERVER_WaitSignal( &sigval );
-        if( sig == SIG_VAR_MODIFIED )
+        n = epoll_wait( pState->epfd, events, MAX_EPOLL_EVENTS, -1 );
+        if ( n < 0 )
         {
-            /* get the handle of the variable which has changed */
-            hVar = (VAR_HANDLE)sigval;
-            UpdateOutput( hVar, pState );
-            result = EOK;
+            result = errno;
         }
-        else if( sig == SIG_VAR_CALC )
+        else
         {
-            hVar = (VAR_HANDLE)sigval;
-            UpdateInput( hVar, pState);
             result = EOK;
-        }
-        else if ( sig == SIG_VAR_PRINT )
-        {
-            /* open a print session */
-            VAR_OpenPrintSession( state.hVarServer,
-                                  sigval,
-                                  &hVar,
-                                  &fd );
 
-            /* print the file variable */
-            PrintStatus( pState, fd );
+            for( i = 0; i < n; i++ )
+            {
+                fd = events[i].data.fd;
+                if ( fd == pState->sigfd )
+                {
+                    /* handle the variable server signals */
+                    HandleVarSignals( pState );
+                }
+                else if ( fd == pState->timerfd )
+                {
+                    /* acknowledge the timer, the expired timers are
+                     * processed below */
+                    read( fd, &expirations, sizeof( expirations ) );
+                }
+                else
+                {
+                    /* handle the line state update */
+                    pGPIO = FindEventGPIO( pState, fd );
+                    if ( pGPIO == NULL )
+                    {
+                        /* unknown file descriptor */
+                    }
+                    else if ( pGPIO->pEncoder != NULL )
+                    {
+                        /* decode both channels of the encoder */
+                        HandleEncoderEvent( pState, pGPIO->pEncoder );
+                    }
+                    else if ( pGPIO->pGroup != NULL )
+                    {
+                        /* update the line group value */
+                        HandleGroupEvent( pState, pGPIO );
+                    }
+                    else
+                    {
+                        HandleGPIOEvent( pState, pGPIO );
+                    }
+                }
+            }
+        }
 
-            /* Close the print session */
-            VAR_ClosePrintSession( state.hVarServer,
-                                   sigval,
-                                   fd );
+        /* process the expired event loop timers */
+        now = GetMonotonicTime();
+        TimerDispatch( &pState->eventQueue, now, now );
 
-            result = EOK;
-        }
-        else
-        {
-            result = ENOTSUP;
-        }
+        /* wait for the next event loop timer */
+        ArmEventTimer( pState );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ParseChip                                                                 */
+/*  ArmEventTimer                                                             */
 /*!
+    Arm the event loop timer file descriptor
 
-  Parse a GPIO chip definition
-
-    The ParseChip function is a callback function for the JSON_Iterate
-    function which parses a GPIO chip definition object.
-    The chip definition object is expected to look as follows:
-
-    { "chip": "chipname", "lines": [<array of line objects>] }
-
-    @param[in]
-       pNode
-            pointer to the chip node
+    The ArmEventTimer function arms the event loop timer file descriptor
+    to expire when the next event loop timer is due, or disarms it if
+    there are no event loop timers.  The timer file descriptor is only
+    updated when the next expiry time changes.
 
     @param[in]
-        arg
-            opaque pointer argument used for the gpioctrl state object
+        pState
+            pointer to the GPIO controller state object
 
-    @retval EOK - the chip object was parsed successfully
-    @retval EINVAL - the chipe object could not be parsed
+    @retval EOK the timer file descriptor was armed
+    @retval EINVAL invalid arguments
+    @retval other error returned by timerfd_settime
 
 ==============================================================================*/
-static int ParseChip( JNode *pNode, void *arg )
+static int ArmEventTimer( GPIOCtrlState *pState )
 {
     int result = EINVAL;
-    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
+    struct itimerspec its;
+    Timer *pTimer;
+    uint64_t due = 0;
 
-    /* create the GPIOChip object */
-    if( CreateChip( pNode, pState ) != NULL )
+    if ( ( pState != NULL ) &&
+         ( pState->timerfd != -1 ) )
     {
-        /* create the GPIO lines in the GPIOChip object */
-        result = CreateLines( pNode, pState );
+        result = EOK;
+
+        pTimer = TimerNext( &pState->eventQueue );
+        if ( pTimer != NULL )
+        {
+            /* a zero expiry time disarms the timer, so expire
+             * overdue timers immediately */
+            due = ( pTimer->due > 0 ) ? pTimer->due : 1;
+        }
+
+        if ( due != pState->timerDue )
+        {
+            memset( &its, 0, sizeof( its ) );
+            its.it_value.tv_sec = due / NS_PER_SEC;
+            its.it_value.tv_nsec = due % NS_PER_SEC;
+            if ( timerfd_settime( pState->timerfd,
+                                  TFD_TIMER_ABSTIME,
+                                  &its,
+                                  NULL ) == 0 )
+            {
+                pState->timerDue = due;
+            }
+            else
+            {
+                result = errno;
+            }
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  CreateChip                                                                */
+/*  HandleGPIOEvent                                                           */
 /*!
-
-    Create a GPIO chip
-
-    The CreateChip function opens a libgpiod chip specified in the JSON
-    node.  The JSON Node is expected to contain a chip name specified
-    using the "chip" key.  A GPIOChip object is allocated on the heap to
-    manage the newly created chip.  The CreateChip function calls the
-    gpiod_chip_open_by_name function in the libgpiod library.
-    If the chip is opened and created successfully, it will be appended
-    to the list of GPIO chips in the GPIOCtrlState object.
+    Handle GPIO input events
+
+    The HandleGPIOEvent function drains the queue of gpio events
+    ( low to high, or high to low transitions on an input pin ) for
+    a line which is ready.  The events are read in batches with up to
+    a full kernel event FIFO per system call.
+
+    By default, only the final state of the line after the queue is
+    drained is written to the system variable associated with the line.
+    If the line is configured to publish all of its events, every
+    transition is written to the variable in the order it occurred.
+    If the line has a debounce interval which could not be applied by the
+    kernel, the events are passed to the userspace debounce filter, which
+    applies each event to the line once the line has settled, whatever
+    the input mode of the line.
+
+    For a counter input, the events are added to the line's edge count,
+    which is published at the publish interval of the line, if it has
+    one, or when the variable is read.  For a frequency input, the event
+    timestamps are added to the frequency measurement, which is published
+    at a fixed rate.  For a pulse width input, the rising and falling edge
+    timestamps are paired to measure each cycle, and each completed
+    measurement is published at the publish interval of the line.
+    The variable is set to 0 or 1 depending on if the transition was
+    high to low, or low to high.
 
     @param[in]
-       pNode
-            pointer to the chip node containing the "chip" name key
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pState
-            pointer to the gpioctrl state object containing the chip list
-            where the newly created GPIOChip object will be appended.
+        pGPIO
+            pointer to the GPIO object associated with the event
 
-    @retval pointer to the newly created GPIOChip
-    @retval NULL the GPIOChip could not be created
+    @retval EOK the events were handled successfully
+    @retval other error reported by VAR_Set()
+    @retval EIO the events could not be read
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static GPIOChip *CreateChip( JNode *pNode, GPIOCtrlState *pState )
+static int HandleGPIOEvent( GPIOCtrlState *pState, GPIO *pGPIO )
 {
-    char *chipName;
-    struct gpiod_chip *pChip;
-    GPIOChip *pGPIOChip = NULL;
-    char buf[BUFSIZ];
+    int result = EINVAL;
+    LineEvent *pEvents;
+    uint64_t timestamp = 0;
+    bool debounce;
+    bool measured = false;
+    int val = -1;
+    int n;
+    int i;
 
-    if ( ( pNode != NULL ) &&
-         ( pState != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
     {
-        /* get the chip name */
-        chipName = JSON_GetStr( pNode, "chip" );
-        if ( chipName != NULL )
-        {
-            /* build the chip name */
-            sprintf(buf, "/dev/%s", chipName );
+        result = EOK;
+        pEvents = pState->lineEvents;
+        debounce = ( pGPIO->debounceInterval > 0 ) &&
+                   ( pGPIO->kernelDebounce == false );
 
-            /* try to open the chip */
-            pChip = gpiod_chip_open( buf );
-            if ( pChip != NULL )
+        /* drain the line event queue */
+        do
+        {
+            n = ReadLineEvents( pState, pGPIO );
+            if ( n > 0 )
             {
-                /* allocate memory for the GPIOChip object */
-                pGPIOChip = calloc( 1, sizeof( GPIOChip ) );
-                if( pGPIOChip != NULL )
-                {
-                    pGPIOChip->name = chipName;
-                    pGPIOChip->pChip = pChip;
+                pState->stats.eventReads++;
+                pState->stats.events += n;
 
-                    /* insert the chip at the tail of the list */
-                    if( pState->pLastGPIOChip == NULL )
+                if ( debounce == true )
+                {
+                    /* wait for the line to settle */
+                    for ( i = 0; i < n; i++ )
                     {
-                        /* first chip found, point both first and last
-                         * pointers at it */
-                        pState->pLastGPIOChip = pGPIOChip;
-                        pState->pFirstGPIOChip = pGPIOChip;
+                        result = DebounceEvent( pState,
+                                                pGPIO,
+                                                &pEvents[i],
+                                                &measured );
                     }
-                    else
+                }
+                else if ( pGPIO->inputMode == INPUT_MODE_COUNTER )
+                {
+                    /* count the edges */
+                    pGPIO->count += n;
+                    pGPIO->timestamp = pEvents[n - 1].timestamp;
+                }
+                else if ( pGPIO->inputMode == INPUT_MODE_FREQUENCY )
+                {
+                    /* measure the edge timestamps */
+                    for ( i = 0; i < n; i++ )
                     {
-                        pState->pLastGPIOChip->pNext = pGPIOChip;
-                        pState->pLastGPIOChip = pGPIOChip;
+                        MeasureEdge( pGPIO, pEvents[i].timestamp );
+                    }
+                }
+                else if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
+                {
+                    /* pair the rising and falling edges */
+                    for ( i = 0; i < n; i++ )
+                    {
+                        if ( MeasurePulse( pGPIO, &pEvents[i] ) == true )
+                        {
+                            measured = true;
+                        }
                     }
                 }
                 else
                 {
-                    /* cloud not allocate memory for the GPIO Chip */
-                    /* clean up resources used by the chip */
-                    gpiod_chip_close( pChip );
+                    for ( i = 0; i < n; i++ )
+                    {
+                        val = pEvents[i].level;
+                        timestamp = pEvents[i].timestamp;
+
+                        if ( pGPIO->publishAll == true )
+                        {
+                            /* write every transition to the variable */
+                            result = PublishValue( pState,
+                                                   pGPIO,
+                                                   val,
+                                                   timestamp );
+                        }
+                    }
                 }
+            }
+            else if ( ( n < 0 ) && ( errno != EAGAIN ) )
+            {
+                result = EIO;
+            }
 
+        } while ( n == EVENT_BATCH_SIZE );
+
+        if ( debounce == true )
+        {
+            if ( measured == true )
+            {
+                /* publish the measurement updated by the settled events */
+                result = PublishLine( pState, pGPIO );
             }
-            else
+        }
+        else if ( pGPIO->inputMode == INPUT_MODE_COUNTER )
+        {
+            if ( pGPIO->publishInterval > 0 )
             {
-                printf("unable to open chip: %s\n", buf );
+                /* publish the count at the publish interval */
+                result = PublishLine( pState, pGPIO );
             }
         }
-        else
+        else if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
         {
-            printf("chip name is NULL\n");
+            if ( measured == true )
+            {
+                /* publish the new pulse width measurement */
+                result = PublishLine( pState, pGPIO );
+            }
+        }
+        else if ( ( val != -1 ) &&
+                  ( pGPIO->inputMode == INPUT_MODE_LEVEL ) &&
+                  ( pGPIO->publishAll == false ) )
+        {
+            /* write the final state to the variable */
+            result = PublishValue( pState, pGPIO, val, timestamp );
         }
     }
 
-    return pGPIOChip;
+    return result;
 }
 
 /*============================================================================*/
-/*  CreateLines                                                               */
+/*  ReadLineEvents                                                            */
 /*!
+    Read a batch of GPIO line events
 
-    Create all the GPIO lines referenced in the JSON definition object
-
-    The CreateLines function iterates through all the lines specified
-    in the GPIO definition object for the current chip being processed.
-    For each line, a GPIO line object is created that associates a
-    variable handle with a gpiod_line object.
-
-    The JSON object is expected to contain a "line" attribute containing
-    an array of line definition objects.
+    The ReadLineEvents function reads up to EVENT_BATCH_SIZE events from
+    a GPIO line into the normalized line event buffer in the GPIO
+    controller state.  Events are read from the GPIO v2 uAPI line
+    file descriptor if the line was requested with the v2 uAPI,
+    otherwise they are read with libgpiod.  The events are recorded
+    in the event history of the line.
 
     @param[in]
-       pNode
-            pointer to the chip node containing the "lines" name key
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pState
-            pointer to the gpioctrl state object containing a reference
-            to the GPIOChip object containing the GPIO line list
-            where the newly created GPIO line objects will be appended.
+        pGPIO
+            pointer to the GPIO object to read events from
 
-    @retval EOK all the lines in the chip were successfully created
-    @retval ENOTSUP invalid JSON object specified in pNode
-    @retval EINVAL invalid arguments
-    @retval other error returned by JSON_Iterate
+    @retval number of events read
+    @retval -1 no events could be read, errno is set
 
 ==============================================================================*/
-static int CreateLines( JNode *pNode, GPIOCtrlState *pState )
+static int ReadLineEvents( GPIOCtrlState *pState, GPIO *pGPIO )
 {
-    int result = EINVAL;
-    JArray *pLines;
+    int n = -1;
+    int i;
+    struct gpiod_line_event *pEvent;
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    ssize_t len;
+#endif
 
-    if ( ( pNode != NULL ) &&
-         ( pState != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
     {
-        /* find the lines */
-        pNode = JSON_Find( pNode, "lines" );
-        if( pNode != NULL )
+        if ( pGPIO->lineFd != -1 )
         {
-            /* confirm it is an array type */
-            if( pNode->type == JSON_ARRAY )
+#ifdef GPIO_V2_GET_LINE_IOCTL
+            len = read( pGPIO->lineFd,
+                        pState->v2events,
+                        sizeof( pState->v2events ) );
+            if ( len >= 0 )
             {
-                pLines = (JArray *)pNode;
-
-                /* iterate through the lines */
-                result = JSON_Iterate( pLines, ParseLine, (void *)pState );
+                n = len / sizeof( struct gpio_v2_line_event );
+                for ( i = 0; i < n; i++ )
+                {
+                    pState->lineEvents[i].timestamp =
+                        pState->v2events[i].timestamp_ns;
+                    pState->lineEvents[i].level =
+                        ( pState->v2events[i].id ==
+                          GPIO_V2_LINE_EVENT_RISING_EDGE ) ? 1 : 0;
+                }
             }
-            else
+#endif
+        }
+        else
+        {
+            n = gpiod_line_event_read_multiple( pGPIO->pLine,
+                                                pState->events,
+                                                EVENT_BATCH_SIZE );
+            for ( i = 0; i < n; i++ )
             {
-                /* JSON type is not supported */
-                result = ENOTSUP;
+                pEvent = &pState->events[i];
+                pState->lineEvents[i].timestamp =
+                    ( (uint64_t)pEvent->ts.tv_sec * NS_PER_SEC ) +
+                    (uint64_t)pEvent->ts.tv_nsec;
+                pState->lineEvents[i].level =
+                    ( pEvent->event_type ==
+                      GPIOD_LINE_EVENT_RISING_EDGE ) ? 1 : 0;
             }
         }
+
+        if ( n > 0 )
+        {
+            RecordHistory( pGPIO, pState->lineEvents, n );
+        }
+    }
+    else
+    {
+        errno = EINVAL;
     }
 
-    return result;
+    return n;
 }
 
 /*============================================================================*/
-/*  ParseLine                                                                 */
+/*  RecordHistory                                                             */
 /*!
-    Parse a GPIO line definition
+    Record line events in the event history of a GPIO line
 
-    The ParseLine function is a callback function for the JSON_Iterate
-    function which parses a GPIO line definition object.
-    The line definition object is expected to look as follows:
-
-    { "line": "<line number>",
-      "var": "<variable name>",
-      "active_state" : "<active state>",
-      "event": "<event_type>",
-      "direction": "<direction>",
-      "drive", "<drive type>",
-      "bias", "<bias type>"
-      }
+    The RecordHistory function copies a batch of line events into the
+    event history ring of the GPIO line, overwriting the oldest entries.
+    The ring is allocated when the line is added to the event index, and
+    is only accessed from the event loop thread, so no locking or
+    allocation is needed here.  Lines without a ring are skipped.
 
     @param[in]
-       pNode
-            pointer to the line node
+        pGPIO
+            pointer to the GPIO object which the events were read from
 
     @param[in]
-        arg
-            opaque pointer argument used for the gpioctrl state object
+        pEvents
+            pointer to the events to record
 
-    @retval EOK - the chip object was parsed successfully
-    @retval EINVAL - the chip object could not be parsed
+    @param[in]
+        n
+            number of events to record
 
 ==============================================================================*/
-static int ParseLine( JNode *pNode, void *arg )
+static void RecordHistory( GPIO *pGPIO, LineEvent *pEvents, int n )
 {
-    int result = EINVAL;
-    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
-    GPIO *pGPIO;
-    int n;
+    HistoryEntry *pEntry;
+    uint64_t seq;
+    int i;
 
-    if ( ( pNode != NULL ) &&
-         ( pState != NULL ) )
+    if ( ( pGPIO != NULL ) &&
+         ( pGPIO->pHistory != NULL ) &&
+         ( pEvents != NULL ) )
     {
-        /* create a GPIO line */
-        pGPIO = CreateLine( pNode, pState );
-        if( pGPIO != NULL )
-        {
-            /* set the line direction */
-            ParseLineDirection( pGPIO, pNode, pState );
+        seq = pGPIO->historySeq;
 
-            /* set the line active state */
-            ParseLineActiveState( pGPIO, pNode );
+        for ( i = 0; i < n; i++ )
+        {
+            pEntry = &pGPIO->pHistory[seq & HISTORY_MASK];
+            pEntry->seq = seq++;
+            pEntry->timestamp = pEvents[i].timestamp;
+            pEntry->level = pEvents[i].level;
+        }
 
-            /* get the line event enable status */
-            ParseLineEvent( pGPIO, pNode );
+        pGPIO->historySeq = seq;
+    }
+}
 
-            /* set the line bias */
-            ParseLineBias( pGPIO, pNode );
+/*============================================================================*/
+/*  ReadLineLevel                                                             */
+/*!
+    Read the level of an input line
 
-            /* set the line drive mode */
-            ParseLineDrive( pGPIO, pNode );
+    The ReadLineLevel function reads the current level of an input line
+    which was requested with either libgpiod or the GPIO v2 uAPI.
 
-            /* request (reserve) the line */
-            RequestLine( pGPIO, pState );
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to read
 
-            /* track monitored events */
-            if ( pGPIO->event_type != 0 )
-            {
-                n = pState->monitoredLines.num_lines;
-                if ( n < GPIOD_LINE_BULK_MAX_LINES )
-                {
-                    pState->monitoredLines.lines[n] = pGPIO->pLine;
-                    pState->monitoredLines.num_lines++;
-                }
-            }
+    @retval 0 the line is inactive
+    @retval 1 the line is active
+    @retval -1 the line could not be requested or read
 
-            /* set up the variable notification on the GPIO line */
-            SetupNotification( pGPIO, pState );
+==============================================================================*/
+static int ReadLineLevel( GPIO *pGPIO )
+{
+    int level = -1;
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    struct gpio_v2_line_values values;
+#endif
 
-            /* create a software PWM if applicable */
-            if ( ( pState->gpiowatch == false ) &&
-                 ( pGPIO->PWM == true ) )
+    if ( ( pGPIO != NULL ) &&
+         ( pGPIO->unusable == false ) )
+    {
+        if ( pGPIO->lineFd != -1 )
+        {
+#ifdef GPIO_V2_GET_LINE_IOCTL
+            values.bits = 0;
+            values.mask = 1;
+            if ( ioctl( pGPIO->lineFd,
+                        GPIO_V2_LINE_GET_VALUES_IOCTL,
+                        &values ) == 0 )
             {
-                CreatePWM( pGPIO );
+                level = ( values.bits & 1 ) ? 1 : 0;
             }
+#endif
+        }
+        else if ( pGPIO->pLine != NULL )
+        {
+            level = gpiod_line_get_value( pGPIO->pLine );
         }
     }
 
-    return EOK;
+    return level;
 }
 
 /*============================================================================*/
-/*  RequestLine                                                               */
+/*  HandleEncoderEvent                                                        */
 /*!
-    Request the line from the gpiod library
-
-    The RequestLine function requests access to the line from the gpiod library
-    It sets up the gpio line direction, active state, bias, and drive mode,
-    as well as setting the value of the line if it is an output.
+    Handle quadrature encoder events
+
+    The HandleEncoderEvent function drains the event queues of both
+    channels of a quadrature encoder, and merges the events of the two
+    channels in timestamp order before passing them to the quadrature
+    decoder, so the order of the transitions between the two lines is
+    preserved.
+
+    The two queues are read one after the other, so a channel may have
+    events waiting in the kernel which are older than the newest event
+    read from the other channel.  A cut time is taken before each pass.
+    Events are only decoded up to the cut, or up to the newest event read
+    from a channel which still has events waiting, whichever is earlier.
+    Later events are held in the channel buffer for the next pass, and
+    passes are repeated until both buffers are empty.
+
+    The events of a channel which is debounced in userspace are decoded
+    by the debounce filter once the channel has settled.  If the encoder
+    position changed, it is published.
 
     @param[in]
-       pGPIO
-            pointer to the GPIO line to request
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pState
-            pointer to the gpioctrl state object
+        pEncoder
+            pointer to the encoder which has events ready
 
-    @retval EOK the line was successfully requested
+    @retval EOK the events were handled successfully
+    @retval other error reported by VAR_Set()
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int RequestLine( GPIO *pGPIO, GPIOCtrlState *pState )
+static int HandleEncoderEvent( GPIOCtrlState *pState, Encoder *pEncoder )
 {
     int result = EINVAL;
-    int rc;
-    bool request = false;
-    int value;
+    EncoderChannel *pChA;
+    EncoderChannel *pChB;
+    int64_t position;
+    uint64_t limit;
+    int n;
 
-    if ( ( pGPIO != NULL ) &&
-         ( pState != NULL ) &&
-         ( pState->service != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pEncoder != NULL ) &&
+         ( pEncoder->pA != NULL ) &&
+         ( pEncoder->pB != NULL ) )
     {
-        /* set the consumer name */
-        pGPIO->request.consumer = pState->service;
-        pGPIO->request.flags = 0;
+        result = EOK;
+        position = pEncoder->position;
+        pChA = &pEncoder->chA;
+        pChB = &pEncoder->chB;
 
-        if( pGPIO->event_type != 0 )
+        do
         {
-            /* if an event type is specified, we auomatically configure
-            the line as an input and set the request type to the specified
-            edge trigger */
-            pGPIO->request.request_type = pGPIO->event_type;
-        }
+            /* events up to the cut are in the queues when they are read */
+            limit = GetMonotonicTime();
 
-        /* perform the line request */
-        request = (((pState->gpiowatch == true) && (pGPIO->event_type != 0)) ||
-                   ((pState->gpiowatch == false) && (pGPIO->event_type == 0)));
+            n = ReadEncoderChannel( pState, pEncoder, pEncoder->pA, pChA );
+            n += ReadEncoderChannel( pState, pEncoder, pEncoder->pB, pChB );
 
-        if ( request == true )
-        {
-            value = pGPIO->value;
+            /* a channel with events waiting may have events older than
+             * the newest event of the other channel */
+            if ( ( pChA->drained == false ) &&
+                 ( pChA->events[pChA->n - 1].timestamp < limit ) )
+            {
+                limit = pChA->events[pChA->n - 1].timestamp;
+            }
 
-            if( pGPIO->PWM == true )
+            if ( ( pChB->drained == false ) &&
+                 ( pChB->events[pChB->n - 1].timestamp < limit ) )
             {
-                /* initial value for sofware PWM lines is 0 */
-                value = 0;
+                limit = pChB->events[pChB->n - 1].timestamp;
             }
 
-            rc = gpiod_line_request( pGPIO->pLine,
-                                     &pGPIO->request,
-                                     value );
+            if ( ( n == 0 ) &&
+                 ( pChA->drained == true ) &&
+                 ( pChB->drained == true ) )
+            {
+                /* there is nothing left to wait for */
+                limit = UINT64_MAX;
+            }
 
-            result = ( rc == -1 ) ? errno : EOK;
-        }
-        else
+            DecodeEncoderEvents( pState, pEncoder, limit );
+
+        } while ( ( pChA->n > 0 ) || ( pChB->n > 0 ) );
+
+        if ( pEncoder->position != position )
         {
-            result = EOK;
+            /* publish the new encoder position */
+            result = PublishLine( pState, pEncoder->pA );
         }
     }
 
@@ -912,414 +2002,426 @@ static int RequestLine( GPIO *pGPIO, GPIOCtrlState *pState )
 }
 
 /*============================================================================*/
-/*  SetupPrintNotifications                                                   */
+/*  ReadEncoderChannel                                                        */
 /*!
-    Set up a render notifications for the GPIO controller
+    Read the events of a quadrature encoder channel
 
-    The SetupPrintNotifications function sets up the render notifications
-    for the GPIO controller.
+    The ReadEncoderChannel function reads the event queue of one channel
+    of a quadrature encoder into the channel buffer, until the queue is
+    drained or the buffer cannot hold another batch of events.
 
     @param[in]
         pState
-            pointer to the GPIO controller state which contains a handle
-            to the variable server for requesting the notifications.
+            pointer to the GPIO controller state object
 
-    @retval EOK the notification was successfully requested
-    @retval ENOENT the requested variable was not found
-    @retval EINVAL invalid arguments
+    @param[in]
+        pEncoder
+            pointer to the encoder which owns the channel
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object of the channel
+
+    @param[in,out]
+        pChannel
+            pointer to the channel buffer
+
+    @retval number of events added to the channel buffer
 
 ==============================================================================*/
-static int SetupPrintNotifications( GPIOCtrlState *pState )
+static int ReadEncoderChannel( GPIOCtrlState *pState,
+                               Encoder *pEncoder,
+                               GPIO *pGPIO,
+                               EncoderChannel *pChannel )
 {
-    int result = EINVAL;
-    VAR_HANDLE hVar;
+    int total = 0;
+    int n = EVENT_BATCH_SIZE;
 
     if ( ( pState != NULL ) &&
-         ( pState->gpiowatch == false ) )
+         ( pEncoder != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( pChannel != NULL ) )
     {
-        hVar = VAR_FindByName( pState->hVarServer, "/SYS/GPIOCTRL/INFO" );
-        if( hVar != VAR_INVALID )
-        {
-            result = VAR_Notify( pState->hVarServer,
-                                 hVar,
-                                 NOTIFY_PRINT );
-        }
-        else
+        pChannel->drained = false;
+
+        while ( ( n == EVENT_BATCH_SIZE ) &&
+                ( ENCODER_BUFFER_SIZE - pChannel->n >= EVENT_BATCH_SIZE ) )
         {
-            result = ENOENT;
+            n = ReadLineEvents( pState, pGPIO );
+            pState->stats.eventReads++;
+
+            if ( n > 0 )
+            {
+                memcpy( &pChannel->events[pChannel->n],
+                        pState->lineEvents,
+                        n * sizeof( LineEvent ) );
+                pChannel->n += n;
+                pState->stats.events += n;
+                total += n;
+            }
+            else if ( ( n < 0 ) && ( errno != EAGAIN ) )
+            {
+                pEncoder->errors++;
+            }
         }
+
+        /* a short read means no more events are waiting */
+        pChannel->drained = ( n < EVENT_BATCH_SIZE );
     }
 
-    return result;
+    return total;
 }
 
 /*============================================================================*/
-/*  SetupNotification                                                         */
+/*  DecodeEncoderEvents                                                       */
 /*!
-    Set up a variable server notification for the GPIO line
+    Decode the buffered events of a quadrature encoder
 
-    The SetupNotification function requests a notification from the variable
-    server for the variable associated with the specified GPIO line.
-
-    GPIO lines in INPUT mode will set up a CALC notification to force a query
-    of the input line when the variable is requested.
-
-    GPIO lines in OUTPUT mode will set up a MODIFIED notification to force
-    the output to be changed when the variable is modified.
-
-    It is assumed that the line direction has already been initialized when
-    this function is called.
+    The DecodeEncoderEvents function merges the buffered events of both
+    channels of a quadrature encoder which occurred up to the specified
+    time in timestamp order, and passes them to the quadrature decoder,
+    or to the debounce filter of a channel which is debounced in
+    userspace.  Later events are kept in the channel buffers.
 
     @param[in]
-       pGPIO
-            pointer to the GPIO line to set up a notification for
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pState
-            pointer to the GPIO controller state which contains a handle
-            to the variable server for requesting the notification.
+        pEncoder
+            pointer to the encoder to decode
 
-    @retval EOK the notification was successfully requested
-    @retval EINVAL invalid arguments
+    @param[in]
+        limit
+            CLOCK_MONOTONIC time of the newest event to decode in
+            nanoseconds
 
 ==============================================================================*/
-static int SetupNotification( GPIO *pGPIO, GPIOCtrlState *pState )
+static void DecodeEncoderEvents( GPIOCtrlState *pState,
+                                 Encoder *pEncoder,
+                                 uint64_t limit )
 {
-    int result = EINVAL;
+    EncoderChannel *pChA;
+    EncoderChannel *pChB;
+    LineEvent *pEvent;
+    GPIO *pGPIO;
+    bool settled = false;
+    int i = 0;
+    int j = 0;
 
-    if ( ( pGPIO != NULL ) &&
-         ( pState != NULL ) &&
-         ( pState->gpiowatch == false ) )
+    if ( ( pState != NULL ) &&
+         ( pEncoder != NULL ) )
     {
-        if ( ( pGPIO->direction == GPIOD_LINE_DIRECTION_INPUT ) &&
-             ( pGPIO->event_type == 0 ) )
-        {
-            result = VAR_Notify( pState->hVarServer,
-                                 pGPIO->hVar,
-                                 NOTIFY_CALC );
-        }
-        else if ( pGPIO->direction == GPIOD_LINE_DIRECTION_OUTPUT )
+        pChA = &pEncoder->chA;
+        pChB = &pEncoder->chB;
+
+        while ( ( ( i < pChA->n ) &&
+                  ( pChA->events[i].timestamp <= limit ) ) ||
+                ( ( j < pChB->n ) &&
+                  ( pChB->events[j].timestamp <= limit ) ) )
         {
-            result = VAR_Notify( pState->hVarServer,
-                                 pGPIO->hVar,
-                                 NOTIFY_MODIFIED );
+            if ( ( j >= pChB->n ) ||
+                 ( pChB->events[j].timestamp > limit ) ||
+                 ( ( i < pChA->n ) &&
+                   ( pChA->events[i].timestamp <=
+                     pChB->events[j].timestamp ) ) )
+            {
+                pGPIO = pEncoder->pA;
+                pEvent = &pChA->events[i++];
+            }
+            else
+            {
+                pGPIO = pEncoder->pB;
+                pEvent = &pChB->events[j++];
+            }
+
+            if ( ( pGPIO->debounceInterval > 0 ) &&
+                 ( pGPIO->kernelDebounce == false ) )
+            {
+                /* wait for the channel to settle */
+                DebounceEvent( pState, pGPIO, pEvent, &settled );
+            }
+            else
+            {
+                DecodeQuadrature( pEncoder, pGPIO, pEvent );
+            }
         }
-    }
 
-    return result;
+        /* keep the events which were not decoded */
+        pChA->n -= i;
+        memmove( pChA->events,
+                 &pChA->events[i],
+                 pChA->n * sizeof( LineEvent ) );
+
+        pChB->n -= j;
+        memmove( pChB->events,
+                 &pChB->events[j],
+                 pChB->n * sizeof( LineEvent ) );
+    }
 }
 
 /*============================================================================*/
-/*  CreateLine                                                                */
+/*  HandleGroupEvent                                                          */
 /*!
-    Create a GPIO line definition
-
-    The CreateLine function creates a GPIO line object which links
-    a varaible handle with a gpiod_line object from the libgpiod
-    library
-
-    The pNode is expected to point to a JSON object which contains
-    the line number and variable name as follows:
+    Handle the events of an input line group member
 
-    "line": "<line number>",
-    "var": "<variable name>",
+    The HandleGroupEvent function drains the line event queue of a
+    member of an input line group, and updates the bit of the group
+    value carried by the member from the final level of the line.  The
+    other bits of the group value are not read.  If the group value
+    has changed, it is published via the first line of the group.
 
     @param[in]
-        pNode
-            pointer to the line node
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pState
-            pointer to the gpioctrl state object which contains
-            a reference to the variable server, and the gpiod_chip
-            object which specifies the chip that the owns this line.
+        pGPIO
+            pointer to the line group member which has events ready
 
-    @retval pointer to the GPIO line object that was created and added to the
-            GPIO line list for the chip we are currently processing
-    @retval NULL the GPIO line could not be created
+    @retval EOK the events were handled successfully
+    @retval EIO the events could not be read
+    @retval EINVAL invalid arguments
+    @retval other error reported by VAR_Set()
 
 ==============================================================================*/
-static GPIO *CreateLine( JNode *pNode, GPIOCtrlState *pState )
+static int HandleGroupEvent( GPIOCtrlState *pState, GPIO *pGPIO )
 {
-    GPIO *pGPIOLine = NULL;
-    VAR_HANDLE hVar = VAR_INVALID;
-    char *line_str;
-    unsigned int line_num;
-    char *varname;
-    GPIOChip *pGPIOChip;
-    struct gpiod_chip *pChip;
-    struct gpiod_line *pLine;
+    int result = EINVAL;
+    LineGroup *pGroup;
+    LineEvent *pEvent = NULL;
+    uint64_t bit;
+    uint64_t value;
+    int n;
 
-    if ( ( pNode != NULL ) &&
-         ( pState != NULL ) &&
-         ( pState->pLastGPIOChip != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( pGPIO->pGroup != NULL ) )
     {
-        /* get a pointer to the GPIOChip object we are currently processing */
-        pGPIOChip = pState->pLastGPIOChip;
-
-        /* get a pointer to the gpiod_chip that is the parent of this line */
-        pChip = pGPIOChip->pChip;
+        result = EOK;
+        pGroup = pGPIO->pGroup;
 
-        /* get a handle to the variable associated with the GPIO line */
-        hVar = GetVarHandle( pState->hVarServer, pNode, &varname );
-        if( hVar != VAR_INVALID )
+        /* drain the line event queue */
+        do
         {
-            /* get the "line" attribute from the GPIO line definition object */
-            line_str = JSON_GetStr( pNode, "line" );
-            if ( line_str != NULL )
+            n = ReadLineEvents( pState, pGPIO );
+            if ( n > 0 )
             {
-                /* convert the line number to an integer */
-                line_num = strtoul( line_str, NULL, 0 );
-
-                /* get a handle to the GPIO line from the GPIOD library */
-                pLine = gpiod_chip_get_line( pChip, line_num );
-                if( pLine != NULL )
-                {
-                    /* allocate memory for the GPIO line object */
-                    pGPIOLine = calloc( 1, sizeof( GPIO ) );
-                    if( pGPIOLine != NULL )
-                    {
-                        /* store the variable handle */
-                        pGPIOLine->hVar = hVar;
-
-                        /* store the variable name */
-                        pGPIOLine->name = varname;
+                pState->stats.eventReads++;
+                pState->stats.events += n;
+                pEvent = &pState->lineEvents[n - 1];
+                pGPIO->value = pEvent->level;
+                pGPIO->timestamp = pEvent->timestamp;
+            }
+            else if ( ( n < 0 ) && ( errno != EAGAIN ) )
+            {
+                result = EIO;
+            }
 
-                        /* store a pointer to the gpiod_line */
-                        pGPIOLine->pLine = pLine;
+        } while ( n == EVENT_BATCH_SIZE );
 
-                        /* store the line number */
-                        pGPIOLine->line_num = line_num;
+        if ( pEvent != NULL )
+        {
+            /* update the member's bit of the group value */
+            bit = 1ULL << pGPIO->groupBit;
+            value = ( pGPIO->value != 0 ) ? ( pGroup->value | bit )
+                                          : ( pGroup->value & ~bit );
 
-                        /* add the GPIO line to the line list */
-                        if ( pGPIOChip->pLastLine == NULL )
-                        {
-                            pGPIOChip->pFirstLine = pGPIOLine;
-                            pGPIOChip->pLastLine = pGPIOLine;
-                        }
-                        else
-                        {
-                            pGPIOChip->pLastLine->pNext = pGPIOLine;
-                            pGPIOChip->pLastLine = pGPIOLine;
-                        }
-                    }
-                    else
-                    {
-                        /* memory allocation failed */
-                        /* clean up the libgpiod resources */
-                        gpiod_line_release( pLine );
-                    }
-                }
-                else
-                {
-                    printf("failed to create line %d\n", line_num );
-                }
-            }
-            else
+            if ( value != pGroup->value )
             {
-                printf("cannot get line\n");
+                pGroup->value = value;
+                pGroup->pLines[0]->timestamp = pGPIO->timestamp;
+
+                /* publish the new group value */
+                result = PublishLine( pState, pGroup->pLines[0] );
             }
         }
-        else
-        {
-            printf("Unable to Get var handle\n");
-        }
     }
 
-    return pGPIOLine;
+    return result;
 }
 
 /*============================================================================*/
-/*  GetVarHandle                                                              */
+/*  DecodeQuadrature                                                          */
 /*!
-    Get the variable handle for the GPIO line
+    Decode a quadrature encoder transition
 
-    The GetVarHandle function looks up the variable handle for the variable
-    specified by the "var" attribute in the GPIO line definition.
+    The DecodeQuadrature function applies a channel event to the state of
+    a quadrature encoder, and looks up the position step for the transition
+    in the quadrature state table.  A step forward is a transition in the
+    sequence 00 -> 10 -> 11 -> 01 -> 00 of the ( A, B ) channel levels.
+    An event which does not change the state, or a transition of both
+    channels at once, indicates a lost edge and is counted as an illegal
+    transition.
 
     @param[in]
-        hVarServer
-            handle to the variable server to query
+        pEncoder
+            pointer to the encoder
 
     @param[in]
-        pNode
-            pointer to the line node to search for the "var" attribute
-
-    @param[out]
-        ppName
-            pointer to the location to store a pointer to the variable name
+        pGPIO
+            pointer to the encoder channel which generated the event
 
-    @retval handle of the specified variable
-    @retval VAR_INVALID if the variable was not found
+    @param[in]
+        pEvent
+            pointer to the channel event
 
 ==============================================================================*/
-static VAR_HANDLE GetVarHandle( VARSERVER_HANDLE hVarServer,
-                                JNode *pNode,
-                                char **ppName )
+static void DecodeQuadrature( Encoder *pEncoder,
+                              GPIO *pGPIO,
+                              LineEvent *pEvent )
 {
-    VAR_HANDLE hVar = VAR_INVALID;
-    char *varname;
-
-    if ( ( hVarServer != NULL ) &&
-         ( pNode != NULL ) &&
-         ( ppName != NULL ) )
+    /* position step indexed by ( previous state << 2 ) | next state */
+    static const int8_t steps[16] =
     {
-        varname = JSON_GetStr( pNode, "var" );
-        if( varname != NULL )
+        QUADRATURE_ILLEGAL, -1, 1, QUADRATURE_ILLEGAL,
+        1, QUADRATURE_ILLEGAL, QUADRATURE_ILLEGAL, -1,
+        -1, QUADRATURE_ILLEGAL, QUADRATURE_ILLEGAL, 1,
+        QUADRATURE_ILLEGAL, 1, -1, QUADRATURE_ILLEGAL
+    };
+    int next;
+    int step;
+
+    if ( ( pEncoder != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( pEvent != NULL ) )
+    {
+        if ( pGPIO == pEncoder->pA )
         {
-            hVar = VAR_FindByName( hVarServer, varname );
-            if( hVar != VAR_INVALID )
-            {
-                /* store a pointer to the variable name */
-                *ppName = varname;
-            }
+            next = ( pEncoder->state & 1 ) | ( pEvent->level ? 2 : 0 );
+        }
+        else
+        {
+            next = ( pEncoder->state & 2 ) | ( pEvent->level ? 1 : 0 );
         }
-    }
 
-    return hVar;
+        step = steps[( pEncoder->state << 2 ) | next];
+        if ( step == QUADRATURE_ILLEGAL )
+        {
+            pEncoder->illegal++;
+        }
+        else
+        {
+            pEncoder->position += step;
+        }
+
+        pEncoder->state = next;
+        pEncoder->pA->timestamp = pEvent->timestamp;
+    }
 }
 
 /*============================================================================*/
-/*  ParseLineDirection                                                        */
+/*  PublishValue                                                              */
 /*!
-    Parse the GPIO definition to set the direction for the specified GPIO line
-
-    The ParseLineDirection function sets the line direction for the
-    GPIO line object.  It is assumed the GPIO line handle has already
-    been assigned to the GPIO object.
+    Publish the value of a GPIO input
 
-    Two valid directions values are supported:  "input" and "output"
+    The PublishValue function stores the value of the GPIO input and
+    the time of the event which produced it, and publishes them to the
+    system variables associated with the GPIO line.
 
-    If the direction is not specified, it is assumed to be an "input"
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
         pGPIO
-            pointer to the GPIO object to store the line information in
+            pointer to the GPIO object to publish
 
     @param[in]
-        pNode
-            pointer to the line node to search for the "direction" attribute
+        value
+            the value to publish
 
     @param[in]
-        pGPIOCtrlState
-            pointer to the GPIO controller state containing the handle to
-            the variable server to get the output value
+        timestamp
+            CLOCK_MONOTONIC time of the event which produced the value
+            in nanoseconds
 
-    @retval EOK the line information object was obtained
-    @retval ENOENT the line information was not found
-    @retval EINVAL invalid arguments or incorrect JSON format
+    @retval EOK the value was published or held for publishing
+    @retval other error reported by VAR_Set() or TimerStart()
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int ParseLineDirection( GPIO *pGPIO,
-                               JNode *pNode,
-                               GPIOCtrlState *pState )
+static int PublishValue( GPIOCtrlState *pState,
+                         GPIO *pGPIO,
+                         uint16_t value,
+                         uint64_t timestamp )
 {
     int result = EINVAL;
-    char *direction;
 
-    if ( ( pGPIO != NULL ) &&
-         ( pGPIO->pLine != NULL ) &&
-         ( pState != NULL ) &&
-         ( pNode != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
     {
-        /* get the "direction" attribute from the GPIO line definition */
-        direction = JSON_GetStr( pNode, "direction" );
-        if ( direction == NULL )
-        {
-            direction = "input";
-        }
+        pGPIO->value = value;
+        pGPIO->timestamp = timestamp;
 
-        if ( strcmp( direction, "input" ) == 0 )
-        {
-            /* set the line to input */
-            pGPIO->direction = GPIOD_LINE_DIRECTION_INPUT;
-            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
-            result = EOK;
-        }
-        else if( strcmp( direction, "output" ) == 0 )
-        {
-            /* set the line to "output" and set the default value */
-            pGPIO->direction = GPIOD_LINE_DIRECTION_OUTPUT;
-            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
-            GetLineOutputValue( pState->hVarServer, pGPIO );
-            result = EOK;
-        }
-        else if( strcmp( direction, "pwm" ) == 0 )
-        {
-            /* set the line to "output" and set the default value */
-            pGPIO->PWM = true;
-            pGPIO->direction = GPIOD_LINE_DIRECTION_OUTPUT;
-            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
-            GetLineOutputValue( pState->hVarServer, pGPIO );
-            result = EOK;
-        }
-        else
-        {
-            result = ENOTSUP;
-        }
+        result = PublishLine( pState, pGPIO );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ParseLineActiveState                                                      */
+/*  PublishLine                                                               */
 /*!
-    Parse the GPIO definition to set the active state for the GPIO line
-
-    The ParseLineActiveState function sets the active state for the
-    GPIO line object.
+    Publish the state of a GPIO input
 
-    Two valid active state values are supported:  "low" and "high"
-
-    If the active state is not specified, it is assumed to be "high"
+    The PublishLine function writes the current state of the GPIO input
+    to the system variables associated with the GPIO line.
 
-    If an active state is specified, the JSON object is expected to have an
-    attribute key "active_state"
+    If the line has a publish interval, the variable is written at most
+    once per interval.  An update which arrives before the interval has
+    elapsed is held, and replaced by any newer update, until the interval
+    expires and the newest state is written.  The final state is always
+    delivered.
 
     @param[in]
-        pGPIO
-            pointer to the GPIO object for the specified line
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pNode
-            pointer to the line node to search for the "active_state" attribute
+        pGPIO
+            pointer to the GPIO object to publish
 
-    @retval EOK the line active state was set up
-    @retval ENOTSUP the specified line active state was not supported
+    @retval EOK the state was published or held for publishing
+    @retval other error reported by VAR_Set() or TimerStart()
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int ParseLineActiveState( GPIO *pGPIO, JNode *pNode )
+static int PublishLine( GPIOCtrlState *pState, GPIO *pGPIO )
 {
     int result = EINVAL;
-    char *active_state;
-    const char *consumer = "gpioctrl";
+    uint64_t now;
 
-    if ( ( pGPIO != NULL ) &&
-         ( pNode != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
     {
-        /* indicate success */
-        result = EOK;
-
-        /* get the "active_state" attribute from the GPIO line definition */
-        active_state = JSON_GetStr( pNode, "active_state" );
-        if ( active_state != NULL )
+        if ( pGPIO->publishInterval == 0 )
         {
-            if ( strcmp( active_state, "low" ) == 0 )
-            {
-                /* set the line to active low */
-                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW;
-            }
-            else if ( strcmp( active_state, "high" ) == 0 )
+            /* publish every update */
+            result = WriteLineVar( pState, pGPIO );
+        }
+        else if ( pGPIO->publishTimer.index >= 0 )
+        {
+            /* replace the update which is waiting to be published */
+            pState->stats.coalesced++;
+            result = EOK;
+        }
+        else
+        {
+            now = GetMonotonicTime();
+            if ( now >= pGPIO->lastPublish + pGPIO->publishInterval )
             {
-                /* set the line to active low */
-                pGPIO->request.flags &= ~GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW;
+                /* the publish interval has elapsed */
+                pGPIO->lastPublish = now;
+                result = WriteLineVar( pState, pGPIO );
             }
             else
             {
-                /* unsupported line active state */
-                result = ENOTSUP;
+                /* hold the update until the publish interval elapses */
+                result = TimerStart( &pState->eventQueue,
+                                     &pGPIO->publishTimer,
+                                     pGPIO->lastPublish +
+                                        pGPIO->publishInterval );
             }
         }
     }
@@ -1328,737 +2430,7497 @@ static int ParseLineActiveState( GPIO *pGPIO, JNode *pNode )
 }
 
 /*============================================================================*/
-/*  ParseLineEvent                                                            */
+/*  PublishTimer                                                              */
 /*!
-    Parse the GPIO definition to see if the GPIO input generates an event
+    Publish a held GPIO input update
 
-    The ParseLineEvent function checks the event attribute to determine
-    if the GPIO input triggers an event on transition.
+    The PublishTimer function is the event loop timer handler which
+    writes the newest value of a rate limited GPIO input to its
+    system variable once the publish interval has elapsed.
+
+    @param[in]
+        pQueue
+            pointer to the event loop timer queue, whose argument is
+            the GPIO controller state
+
+    @param[in]
+        pTimer
+            pointer to the publish timer which expired
+
+    @param[in]
+        now
+            current CLOCK_MONOTONIC time in nanoseconds
 
-    Two valid event state values are supported:  true and false
+==============================================================================*/
+static void PublishTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now )
+{
+    GPIOCtrlState *pState;
+    GPIO *pGPIO;
+
+    if ( ( pQueue != NULL ) && ( pTimer != NULL ) )
+    {
+        pState = (GPIOCtrlState *)pQueue->arg;
+        pGPIO = (GPIO *)pTimer->arg;
+        if ( ( pState != NULL ) && ( pGPIO != NULL ) )
+        {
+            pGPIO->lastPublish = now;
+            WriteLineVar( pState, pGPIO );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  DebounceEvent                                                             */
+/*!
+    Pass an input event through the debounce filter
 
-    If the event state is not specified, it is assumed to be false
+    The DebounceEvent function holds the newest event of a GPIO input
+    which is debounced in userspace, and (re)starts its settling deadline
+    in the event loop timer queue.  The deadline is measured from the
+    kernel timestamp of the event, so events which are read late, or in
+    the same batch, are filtered by when they occurred rather than by
+    when they were read.  If the held event had been stable for the
+    debounce interval when the new event occurred it is applied to the
+    line, otherwise it is discarded and counted as debounced.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
         pGPIO
-            pointer to the GPIO object for the specified line
+            pointer to the GPIO object which generated the event
 
     @param[in]
-        pNode
-            pointer to the line node to search for the "event" attribute
+        pEvent
+            pointer to the line event
 
-    @retval EOK the line event state was set up
-    @retval ENOTSUP the specified line event state was not supported
+    @param[in,out]
+        pPublish
+            set to true if a settled event updated a measurement which
+            must be published.  It is not changed otherwise.
+
+    @retval EOK the event was passed to the debounce filter
+    @retval ENOMEM the event loop timer queue could not be grown
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int ParseLineEvent( GPIO *pGPIO, JNode *pNode )
+static int DebounceEvent( GPIOCtrlState *pState,
+                          GPIO *pGPIO,
+                          LineEvent *pEvent,
+                          bool *pPublish )
 {
     int result = EINVAL;
-    char *event_state;
-    int event_type;
-    const char *consumer = "gpioctrl";
 
-    if ( ( pGPIO != NULL ) &&
-         ( pNode != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( pEvent != NULL ) &&
+         ( pPublish != NULL ) )
     {
-        /* indicate success */
-        result = EOK;
-
-        /* get the "active_state" attribute from the GPIO line definition */
-        event_state = JSON_GetStr( pNode, "event" );
-        if ( event_state != NULL )
+        if ( pGPIO->debounceTimer.index >= 0 )
         {
-            if ( strcmp( event_state, "RISING_EDGE" ) == 0 )
-            {
-                /* event monitoring for rising edges */
-                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_RISING_EDGE;
-            }
-            else if ( strcmp( event_state, "FALLING_EDGE" ) == 0 )
-            {
-                /* event monitoring for falling edges */
-                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE;
-            }
-            else if ( strcmp( event_state, "BOTH_EDGES") == 0 )
+            TimerStop( &pState->eventQueue, &pGPIO->debounceTimer );
+
+            if ( pEvent->timestamp >= pGPIO->debounceEvent.timestamp +
+                                      pGPIO->debounceInterval )
             {
-                /* event monitoring for both edges */
-                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
+                /* the held event settled before this event occurred */
+                if ( SettleEvent( pState, pGPIO ) == true )
+                {
+                    *pPublish = true;
+                }
             }
             else
             {
-                /* unsupported line active state */
-                pGPIO->event_type = 0;
-                result = ENOTSUP;
+                /* the held event did not settle */
+                pState->stats.debounced++;
             }
         }
-        else
-        {
-            pGPIO->event_type = 0;
-        }
+
+        pGPIO->debounceEvent = *pEvent;
+
+        /* start the settling deadline at the time of the event */
+        result = TimerStart( &pState->eventQueue,
+                             &pGPIO->debounceTimer,
+                             pEvent->timestamp + pGPIO->debounceInterval );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ParseLineBias                                                             */
+/*  SettleEvent                                                               */
 /*!
-    Parse the GPIO definition to set the bias for the GPIO line
-
-    The ParseLineBias function sets the bias for the
-    GPIO line object.
-
-    Three valid bias state values are supported:
-        "disabled", "pull-down", "pull-up"
-
-    If the bias is not specified, it is assumed to be "disabled"
+    Apply a settled event to a debounced GPIO input
 
-    If a bias is specified, the JSON object is expected to have an
-    attribute key "bias"
+    The SettleEvent function applies the held event of a debounced GPIO
+    input once the line has been stable for the debounce interval.
+    An event which returns a line with both edge events to the level it
+    had before the bounce is counted as debounced.  Otherwise the event
+    is handled as it would be without the filter: a level input publishes
+    the new level, a counter counts the edge, a frequency, pulse width or
+    encoder input adds the edge to its measurement.
 
     @param[in]
-        pGPIO
-            pointer to the GPIO object for the specified line
+        pState
+            pointer to the GPIO controller state object
 
     @param[in]
-        pNode
-            pointer to the line node to search for the "bias" attribute
+        pGPIO
+            pointer to the GPIO object with the settled event
 
-    @retval EOK the line bias was set up
-    @retval ENOTSUP the specified line bias was not supported
-    @retval EINVAL invalid arguments or incorrect JSON format
+    @retval true the event updated a measurement which must be published
+    @retval false there is nothing more to publish
 
 ==============================================================================*/
-static int ParseLineBias( GPIO *pGPIO, JNode *pNode )
+static bool SettleEvent( GPIOCtrlState *pState, GPIO *pGPIO )
 {
-    int result = EINVAL;
-    char *bias;
+    bool publish = false;
+    LineEvent *pEvent;
+    Encoder *pEncoder;
+    int64_t position;
+    int level;
 
-    if ( ( pGPIO != NULL ) &&
-         ( pNode != NULL ) )
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
     {
-        /* indicate success */
-        result = EOK;
+        pEvent = &pGPIO->debounceEvent;
+        pEncoder = pGPIO->pEncoder;
 
-        /* get the "bias" attribute from the GPIO line definition */
-        bias = JSON_GetStr( pNode, "bias" );
-        if ( bias != NULL )
+        /* get the settled level of the line */
+        if ( ( pGPIO->inputMode == INPUT_MODE_ENCODER ) &&
+             ( pEncoder != NULL ) )
         {
-            if ( strcmp( bias, "disabled" ) == 0 )
+            level = ( pGPIO == pEncoder->pA ) ? ( pEncoder->state >> 1 ) & 1
+                                              : pEncoder->state & 1;
+        }
+        else
+        {
+            level = pGPIO->value;
+        }
+
+        if ( ( pEvent->level == level ) &&
+             ( pGPIO->event_type == GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES ) )
+        {
+            /* the input bounced back to its settled level */
+            pState->stats.debounced++;
+        }
+        else if ( pGPIO->inputMode == INPUT_MODE_LEVEL )
+        {
+            /* publish the settled level */
+            PublishValue( pState, pGPIO, pEvent->level, pEvent->timestamp );
+        }
+        else
+        {
+            if ( pGPIO->inputMode == INPUT_MODE_COUNTER )
             {
-                /* set the bias to disabled */
-                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_BIAS_DISABLE;
+                /* count the edge */
+                pGPIO->count++;
+                pGPIO->timestamp = pEvent->timestamp;
+                publish = ( pGPIO->publishInterval > 0 );
             }
-            else if ( strcmp( bias, "pull-down" ) == 0 )
+            else if ( pGPIO->inputMode == INPUT_MODE_FREQUENCY )
             {
-                /* set the bias to pull-down */
-                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_DOWN;
+                /* the frequency is published at a fixed rate */
+                MeasureEdge( pGPIO, pEvent->timestamp );
             }
-            else if ( strcmp( bias, "pull-up" ) == 0 )
+            else if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
             {
-                /* set the bias to pull-up */
-                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP;
+                publish = MeasurePulse( pGPIO, pEvent );
             }
-            else
+            else if ( pEncoder != NULL )
             {
-                result = ENOTSUP;
+                position = pEncoder->position;
+                DecodeQuadrature( pEncoder, pGPIO, pEvent );
+                publish = ( pEncoder->position != position );
             }
+
+            /* track the settled level of the edge inputs */
+            pGPIO->value = pEvent->level;
         }
     }
 
-    return result;
+    return publish;
 }
 
 /*============================================================================*/
-/*  ParseLineDrive                                                            */
+/*  DebounceTimer                                                             */
 /*!
-    Parse the GPIO definition to set the drive mode for the GPIO line
+    Apply a settled GPIO input event
 
-    The ParseLineDrive function sets the drive mode for the GPIO line object.
-
-    Three valid drive mode values are supported:
-        "push-pull", "open-drain", "open-source"
-
-    If the drive mode is not specified, it is assumed to be "push-pull"
-
-    If a drive mode is specified, the JSON object is expected to have an
-    attribute key "drive"
+    The DebounceTimer function is the event loop timer handler which is
+    invoked when a debounced GPIO input has been stable for the debounce
+    interval after its last event.  The held event is applied to the line,
+    and any measurement it updated is published.
 
     @param[in]
-        pGPIO
-            pointer to the GPIO object for the specified line
+        pQueue
+            pointer to the event loop timer queue, whose argument is
+            the GPIO controller state
 
     @param[in]
-        pNode
-            pointer to the line node to search for the "drive" attribute
+        pTimer
+            pointer to the debounce timer which expired
 
-    @retval EOK the line bias was set up
-    @retval ENOTSUP the specified line bias was not supported
-    @retval EINVAL invalid arguments or incorrect JSON format
+    @param[in]
+        now
+            current CLOCK_MONOTONIC time in nanoseconds
 
 ==============================================================================*/
-static int ParseLineDrive( GPIO *pGPIO, JNode *pNode )
+static void DebounceTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now )
 {
-    int result = EINVAL;
-    char *drive;
-    int pushpull = ~( GPIOD_LINE_REQUEST_FLAG_OPEN_DRAIN |
-                      GPIOD_LINE_REQUEST_FLAG_OPEN_SOURCE );
+    GPIOCtrlState *pState;
+    GPIO *pGPIO;
 
-    if ( ( pGPIO != NULL ) &&
-         ( pNode != NULL ) )
-    {
-        /* indicate success */
-        result = EOK;
+    (void)now;
 
-        /* get the "drive" attribute from the GPIO line definition */
-        drive = JSON_GetStr( pNode, "drive" );
-        if ( drive != NULL )
+    if ( ( pQueue != NULL ) &&
+         ( pTimer != NULL ) )
+    {
+        pState = (GPIOCtrlState *)pQueue->arg;
+        pGPIO = (GPIO *)pTimer->arg;
+        if ( ( pState != NULL ) &&
+             ( pGPIO != NULL ) &&
+             ( SettleEvent( pState, pGPIO ) == true ) )
         {
-            if ( strcmp( drive, "push-pull" ) == 0 )
-            {
-                /* set the drive to push-pull by clearing the open-source
-                 * and open-drain bits */
-                pGPIO->request.flags &= pushpull;
-            }
-            else if ( strcmp( drive, "open-source" ) == 0 )
-            {
-                /* set the drive mode to open-source */
-                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_OPEN_SOURCE;
-            }
-            else if ( strcmp( drive, "open-drain" ) == 0 )
-            {
-                /* set the drive mode to open-drain */
-                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_OPEN_DRAIN;
-            }
-            else
-            {
-                result = ENOTSUP;
-            }
+            /* an encoder position is published through channel A */
+            PublishLine( pState,
+                         ( pGPIO->pEncoder != NULL ) ? pGPIO->pEncoder->pA
+                                                     : pGPIO );
         }
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  GetLineOutputValue                                                        */
+/*  MeasureEdge                                                               */
 /*!
-    Get the value from the variable associated with the GPIO output line
+    Add an edge to a frequency measurement
 
-    The GetLineOutputValue function gets the value from the variable associated
-    with the specified GPIO line but only if the line direction is "output".
-
-    The type of the variable must be VARTYPE_UINT16
-
-    The line direction must be "output"
-
-    @param[in]
-        hVarServer
-            handle to the variable server to query the variable value
+    The MeasureEdge function adds the kernel timestamp of an edge to the
+    current frequency measurement of a frequency input.  If the line
+    measures over a fixed number of periods, the frequency is calculated
+    as soon as that many periods have been observed.
 
     @param[in]
         pGPIO
-            pointer to the GPIO object to store the variable value
+            pointer to the frequency input
 
-    @retval EOK the variable value was successfully retrieved
-    @retval ENOENT the variable was not found
-    @retval ENOTSUP invalid variable type or incorrect direction
-    @retval EINVAL invalid arguments
+    @param[in]
+        timestamp
+            CLOCK_MONOTONIC time of the edge in nanoseconds
 
 ==============================================================================*/
-static int GetLineOutputValue( VARSERVER_HANDLE hVarServer, GPIO *pGPIO )
+static void MeasureEdge( GPIO *pGPIO, uint64_t timestamp )
 {
-    int result = EINVAL;
-    VarObject var;
-    int direction;
-
-    if ( ( hVarServer != NULL ) &&
-         ( pGPIO != NULL ) &&
-         ( pGPIO->hVar != VAR_INVALID ) &&
-         ( pGPIO->pLine != NULL ) )
+    if ( pGPIO != NULL )
     {
-        /* get the line direction */
-        direction = pGPIO->direction;
-        if ( direction == GPIOD_LINE_DIRECTION_OUTPUT )
+        if ( pGPIO->freqEdges == 0 )
         {
-            /* get the variable value */
-            if ( VAR_Get( hVarServer, pGPIO->hVar, &var ) == EOK )
-            {
-                if( var.type == VARTYPE_UINT16 )
-                {
-                    /* get the requested GPIO output value and store it
-                     * in the GPIO object */
-                    pGPIO->value = var.val.ui;
-
-                    /* indicate success */
-                    result = EOK;
-                }
-                else
-                {
-                    result = ENOTSUP;
-                }
-            }
-            else
-            {
-                /* cannot get variable */
-                result = ENOENT;
-            }
+            /* start a new measurement */
+            pGPIO->freqFirst = timestamp;
         }
-        else
+
+        pGPIO->freqLast = timestamp;
+        pGPIO->timestamp = timestamp;
+        pGPIO->freqEdges++;
+
+        if ( ( pGPIO->freqPeriods > 0 ) &&
+             ( pGPIO->freqEdges > pGPIO->freqPeriods ) )
         {
-            /* unsupported operation */
-            result = ENOTSUP;
+            /* the requested number of periods has been observed */
+            MeasureFrequency( pGPIO );
         }
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  FindGPIO                                                                  */
+/*  MeasurePulse                                                              */
 /*!
-    Find a GPIO given a handle to its associated variable
+    Add an edge to a pulse width measurement
 
-    The FindGPIO function iterates through all of the GPIO chips looking
-    for the GPIO line associated with the specified variable handle.
+    The MeasurePulse function pairs the rising and falling edges of a
+    pulse width input.  Each rising edge which follows a falling edge
+    completes a cycle, whose high time is the time from the previous
+    rising edge to the falling edge, and whose low time is the time
+    from the falling edge to this rising edge.  Once the configured
+    number of cycles have been completed, their average high and low
+    times become the new measurement.
 
     @param[in]
-        pState
-            pointer to the GPIOCtrl state which contains the list of
-            GPIO chips to search
+        pGPIO
+            pointer to the pulse width input
 
     @param[in]
-        hVar
-            handle of the variable to search for
+        pEvent
+            pointer to the edge event
 
-    @retval pointer to the GPIO line object associated with the specified var
-    @retval NULL if the GPIO line object could not be found
+    @retval true a new measurement was completed
+    @retval false no measurement was completed
 
 ==============================================================================*/
-static GPIO *FindGPIO( GPIOCtrlState *pState, VAR_HANDLE hVar )
+static bool MeasurePulse( GPIO *pGPIO, LineEvent *pEvent )
 {
-    GPIOChip *pGPIOChip;
-    GPIO *pGPIO;
-    GPIO *foundGPIO = NULL;
-    bool found = false;
+    bool measured = false;
 
-    if ( ( pState != NULL ) &&
-         ( hVar != VAR_INVALID ) )
+    if ( ( pGPIO != NULL ) &&
+         ( pEvent != NULL ) )
     {
-        /* start looking in the first GPIO chip */
-        pGPIOChip = pState->pFirstGPIOChip;
-        while ( ( pGPIOChip != NULL ) && ( found == false ) )
+        if ( pEvent->level == 1 )
         {
-            /* start looking in the first line of the chip */
-            pGPIO = pGPIOChip->pFirstLine;
-            while( ( pGPIO != NULL ) && ( found == false ) )
+            if ( ( pGPIO->pulseRise != 0 ) &&
+                 ( pGPIO->pulseFall > pGPIO->pulseRise ) &&
+                 ( pEvent->timestamp > pGPIO->pulseFall ) )
             {
-                /* check for a variable handle match */
-                if( pGPIO->hVar == hVar )
-                {
-                    /* save the found GPIO line */
-                    foundGPIO = pGPIO;
+                /* a complete cycle has been observed */
+                pGPIO->pulseHighSum += pGPIO->pulseFall - pGPIO->pulseRise;
+                pGPIO->pulseLowSum += pEvent->timestamp - pGPIO->pulseFall;
+                pGPIO->pulseCount++;
 
-                    /* abort the search */
-                    found = true;
+                if ( pGPIO->pulseCount >= pGPIO->pulseCycles )
+                {
+                    /* average the cycles of the measurement */
+                    pGPIO->pulseHigh = pGPIO->pulseHighSum / pGPIO->pulseCount;
+                    pGPIO->pulseLow = pGPIO->pulseLowSum / pGPIO->pulseCount;
+                    pGPIO->pulseHighSum = 0;
+                    pGPIO->pulseLowSum = 0;
+                    pGPIO->pulseCount = 0;
+                    pGPIO->timestamp = pEvent->timestamp;
+                    measured = true;
                 }
-
-                /* move on to the next GPIO line */
-                pGPIO = pGPIO->pNext;
             }
 
-            /* move to the next GPIO chip */
-            pGPIOChip = pGPIOChip->pNext;
+            pGPIO->pulseRise = pEvent->timestamp;
+        }
+        else
+        {
+            pGPIO->pulseFall = pEvent->timestamp;
         }
     }
 
-    /* return the found GPIO, or NULL if it is not found */
-    return foundGPIO;
+    return measured;
 }
 
 /*============================================================================*/
-/*  FindVar                                                                  */
+/*  MeasureFrequency                                                          */
 /*!
-    Find a Variable given a handle to its associated gpiod line
+    Calculate the frequency of an input
 
-    The FindVar function iterates through all of the GPIO chips looking
-    for the variable handle associated with the specified gpiod line
-
-    @param[in]
-        pState
-            pointer to the GPIOCtrl state which contains the list of
-            GPIO chips to search
+    The MeasureFrequency function calculates the average frequency of
+    the periods in the current measurement, from the timestamps of its
+    first and last edges.  The next measurement starts at the last
+    edge, so no periods are lost between measurements.  If fewer than
+    two edges have been observed, the measurement is extended and the
+    previous frequency is kept.
 
     @param[in]
-        pLine
-            pointer to the gpiod_line object to search for
-
-    @retval handle to the variable associated with the gpiod line
-    @retval VAR_INVALID if the variable could not be found
+        pGPIO
+            pointer to the frequency input
 
 ==============================================================================*/
-static VAR_HANDLE FindVar( GPIOCtrlState *pState, struct gpiod_line *pLine )
+static void MeasureFrequency( GPIO *pGPIO )
 {
-    VAR_HANDLE hVar = VAR_INVALID;
-    GPIOChip *pGPIOChip;
-    GPIO *pGPIO;
-    bool found = false;
-
+    if ( ( pGPIO != NULL ) &&
+         ( pGPIO->freqEdges >= 2 ) &&
+         ( pGPIO->freqLast > pGPIO->freqFirst ) )
+    {
+        pGPIO->frequency = (double)( pGPIO->freqEdges - 1 ) *
+                           (double)NS_PER_SEC /
+                           (double)( pGPIO->freqLast - pGPIO->freqFirst );
+
+        /* start the next measurement at the last edge */
+        pGPIO->freqFirst = pGPIO->freqLast;
+        pGPIO->freqEdges = 1;
+    }
+}
+
+/*============================================================================*/
+/*  FrequencyTimer                                                            */
+/*!
+    Publish the frequency of an input
+
+    The FrequencyTimer function is the event loop timer handler which
+    publishes the frequency of a frequency input at a fixed rate.
+    If the line does not measure over a fixed number of periods,
+    the frequency of the periods observed since the last measurement
+    is calculated.  If no edge has occurred within the timeout, the
+    frequency is 0 Hz.  The timer is then restarted for the next
+    publish interval.
+
+    @param[in]
+        pQueue
+            pointer to the event loop timer queue, whose argument is
+            the GPIO controller state
+
+    @param[in]
+        pTimer
+            pointer to the frequency timer which expired
+
+    @param[in]
+        now
+            current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static void FrequencyTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now )
+{
+    GPIOCtrlState *pState;
+    GPIO *pGPIO;
+    uint64_t due;
+
+    if ( ( pQueue != NULL ) &&
+         ( pTimer != NULL ) )
+    {
+        pState = (GPIOCtrlState *)pQueue->arg;
+        pGPIO = (GPIO *)pTimer->arg;
+        if ( ( pState != NULL ) &&
+             ( pGPIO != NULL ) )
+        {
+            if ( pGPIO->freqPeriods == 0 )
+            {
+                MeasureFrequency( pGPIO );
+            }
+
+            if ( ( pGPIO->freqEdges == 0 ) ||
+                 ( now - pGPIO->freqLast >= pGPIO->freqTimeout ) )
+            {
+                /* the input has stopped */
+                pGPIO->frequency = 0.0;
+                pGPIO->freqEdges = 0;
+            }
+
+            WriteLineVar( pState, pGPIO );
+
+            /* publish at a fixed rate, skipping missed intervals */
+            due = pTimer->due + pGPIO->publishInterval;
+            if ( due <= now )
+            {
+                due = now + pGPIO->publishInterval;
+            }
+
+            TimerStart( pQueue, pTimer, due );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  WriteLineVar                                                              */
+/*!
+    Write the value of a GPIO input to its variable
+
+    The WriteLineVar function writes the current value of the GPIO input,
+    the edge count of a counter input, the frequency or period of a
+    frequency input, the position of a quadrature encoder, the pulse
+    width or duty cycle of a pulse width input, or the value of a line
+    group, to the system variable associated with the GPIO line.
+    If the line
+    has a timestamp variable, the event timestamp is written first, so
+    it is up to date when clients are notified of the new value.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to write
+
+    @retval EOK the value was written successfully
+    @retval other error reported by VAR_Set()
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int WriteLineVar( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    VarObject var;
+    double value;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        if ( pGPIO->hTimestampVar != VAR_INVALID )
+        {
+            /* write the time of the event */
+            WriteTimestampVar( pState, pGPIO );
+        }
+
+        if ( pGPIO->pGroup != NULL )
+        {
+            /* write the line group value */
+            result = SetVarValue( pState,
+                                  pGPIO->hVar,
+                                  pGPIO->pGroup->varType,
+                                  pGPIO->pGroup->value );
+        }
+        else if ( pGPIO->inputMode == INPUT_MODE_COUNTER )
+        {
+            /* write the count to the variable */
+            result = SetVarValue( pState,
+                                  pGPIO->hVar,
+                                  pGPIO->varType,
+                                  pGPIO->count );
+        }
+        else if ( ( pGPIO->inputMode == INPUT_MODE_ENCODER ) &&
+                  ( pGPIO->pEncoder != NULL ) )
+        {
+            /* write the encoder position */
+            if ( pGPIO->varType == VARTYPE_FLOAT )
+            {
+                result = SetVarDouble( pState,
+                                       pGPIO->hVar,
+                                       pGPIO->varType,
+                                       (double)pGPIO->pEncoder->position );
+            }
+            else
+            {
+                result = SetVarValue( pState,
+                                      pGPIO->hVar,
+                                      pGPIO->varType,
+                                      (uint64_t)pGPIO->pEncoder->position );
+            }
+        }
+        else if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
+        {
+            if ( pGPIO->pulseMeasure == PULSE_MEASURE_HIGH )
+            {
+                /* high time in microseconds */
+                value = (double)pGPIO->pulseHigh / (double)NS_PER_US;
+            }
+            else if ( pGPIO->pulseMeasure == PULSE_MEASURE_LOW )
+            {
+                /* low time in microseconds */
+                value = (double)pGPIO->pulseLow / (double)NS_PER_US;
+            }
+            else
+            {
+                /* duty cycle in percent */
+                value = ( pGPIO->pulseHigh + pGPIO->pulseLow > 0 )
+                        ? 100.0 * (double)pGPIO->pulseHigh /
+                          (double)( pGPIO->pulseHigh + pGPIO->pulseLow )
+                        : 0.0;
+            }
+
+            /* write the pulse width measurement */
+            result = SetVarDouble( pState,
+                                   pGPIO->hVar,
+                                   pGPIO->varType,
+                                   value );
+        }
+        else if ( pGPIO->inputMode == INPUT_MODE_FREQUENCY )
+        {
+            value = pGPIO->frequency;
+            if ( pGPIO->measurePeriod == true )
+            {
+                /* convert the frequency to a period in microseconds */
+                value = ( value > 0.0 ) ? 1000000.0 / value : 0.0;
+            }
+
+            /* write the frequency or period */
+            result = SetVarDouble( pState,
+                                   pGPIO->hVar,
+                                   pGPIO->varType,
+                                   value );
+        }
+        else
+        {
+            /* set the value of the variable */
+            var.val.ui = pGPIO->value;
+            var.type = VARTYPE_UINT16;
+            var.len = sizeof(uint16_t);
+
+            /* write to the variable */
+            result = VAR_Set( pState->hVarServer,
+                              pGPIO->hVar,
+                              &var );
+        }
+
+        pState->stats.updates++;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetVarType                                                                */
+/*!
+    Get the type of a variable
+
+    The GetVarType function gets the type of the specified variable
+    from the variable server, so it can be cached and used to write
+    the variable without looking it up again.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        hVar
+            handle to the variable
+
+    @retval the type of the variable
+    @retval VARTYPE_INVALID the variable type could not be obtained
+
+==============================================================================*/
+static VarType GetVarType( GPIOCtrlState *pState, VAR_HANDLE hVar )
+{
+    VarType type = VARTYPE_INVALID;
+    VarObject var;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        if ( VAR_Get( pState->hVarServer, hVar, &var ) == EOK )
+        {
+            type = var.type;
+        }
+    }
+
+    return type;
+}
+
+/*============================================================================*/
+/*  GetVarInteger                                                             */
+/*!
+    Read an integer value from a variable
+
+    The GetVarInteger function reads the value of an integer variable,
+    or truncates the value of a floating point variable.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        hVar
+            handle to the variable to read
+
+    @param[out]
+        pValue
+            pointer to the location to store the value
+
+    @retval EOK the value was read
+    @retval ENOTSUP the variable type is not supported
+    @retval ENOENT the variable could not be read
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int GetVarInteger( GPIOCtrlState *pState,
+                          VAR_HANDLE hVar,
+                          uint64_t *pValue )
+{
+    int result = EINVAL;
+    VarObject var;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) &&
+         ( pValue != NULL ) )
+    {
+        if ( VAR_Get( pState->hVarServer, hVar, &var ) == EOK )
+        {
+            result = EOK;
+
+            switch( var.type )
+            {
+                case VARTYPE_UINT16:
+                    *pValue = var.val.ui;
+                    break;
+
+                case VARTYPE_INT16:
+                    *pValue = (uint64_t)(int64_t)var.val.i;
+                    break;
+
+                case VARTYPE_UINT32:
+                    *pValue = var.val.ul;
+                    break;
+
+                case VARTYPE_INT32:
+                    *pValue = (uint64_t)(int64_t)var.val.l;
+                    break;
+
+                case VARTYPE_UINT64:
+                    *pValue = var.val.ull;
+                    break;
+
+                case VARTYPE_INT64:
+                    *pValue = (uint64_t)var.val.ll;
+                    break;
+
+                case VARTYPE_FLOAT:
+                    *pValue = (uint64_t)(int64_t)var.val.f;
+                    break;
+
+                default:
+                    result = ENOTSUP;
+                    break;
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetVarValue                                                               */
+/*!
+    Write a numeric value to a variable
+
+    The SetVarValue function converts a 64-bit unsigned value to the
+    specified variable type and writes it to the variable.  Values which
+    exceed the range of a narrower integer type are truncated.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        hVar
+            handle to the variable to write
+
+    @param[in]
+        type
+            the type of the variable
+
+    @param[in]
+        value
+            the value to write
+
+    @retval EOK the value was written successfully
+    @retval ENOTSUP the variable type is not supported
+    @retval other error reported by VAR_Set()
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetVarValue( GPIOCtrlState *pState,
+                        VAR_HANDLE hVar,
+                        VarType type,
+                        uint64_t value )
+{
+    int result = EINVAL;
+    VarObject var;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        result = EOK;
+        var.type = type;
+
+        switch( type )
+        {
+            case VARTYPE_UINT16:
+                var.val.ui = (uint16_t)value;
+                var.len = sizeof(uint16_t);
+                break;
+
+            case VARTYPE_INT16:
+                var.val.i = (int16_t)value;
+                var.len = sizeof(int16_t);
+                break;
+
+            case VARTYPE_UINT32:
+                var.val.ul = (uint32_t)value;
+                var.len = sizeof(uint32_t);
+                break;
+
+            case VARTYPE_INT32:
+                var.val.l = (int32_t)value;
+                var.len = sizeof(int32_t);
+                break;
+
+            case VARTYPE_UINT64:
+                var.val.ull = value;
+                var.len = sizeof(uint64_t);
+                break;
+
+            case VARTYPE_INT64:
+                var.val.ll = (int64_t)value;
+                var.len = sizeof(int64_t);
+                break;
+
+            case VARTYPE_FLOAT:
+                var.val.f = (float)value;
+                var.len = sizeof(float);
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+
+        if ( result == EOK )
+        {
+            result = VAR_Set( pState->hVarServer, hVar, &var );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetVarDouble                                                              */
+/*!
+    Write a real value to a variable
+
+    The SetVarDouble function writes a real value to a floating point
+    variable, or rounds it to the nearest integer for an integer variable.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        hVar
+            handle to the variable to write
+
+    @param[in]
+        type
+            the type of the variable
+
+    @param[in]
+        value
+            the non-negative value to write
+
+    @retval EOK the value was written successfully
+    @retval ENOTSUP the variable type is not supported
+    @retval other error reported by VAR_Set()
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetVarDouble( GPIOCtrlState *pState,
+                         VAR_HANDLE hVar,
+                         VarType type,
+                         double value )
+{
+    int result = EINVAL;
+    VarObject var;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        if ( type == VARTYPE_FLOAT )
+        {
+            var.type = VARTYPE_FLOAT;
+            var.val.f = (float)value;
+            var.len = sizeof(float);
+
+            result = VAR_Set( pState->hVarServer, hVar, &var );
+        }
+        else
+        {
+            result = SetVarValue( pState,
+                                  hVar,
+                                  type,
+                                  (uint64_t)( value + 0.5 ) );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WriteTimestampVar                                                         */
+/*!
+    Write the event timestamp of a GPIO input to its timestamp variable
+
+    The WriteTimestampVar function writes the time of the event which
+    produced the current value of the GPIO input to the timestamp
+    variable of the GPIO line, as a 64-bit count of nanoseconds.
+
+    A line requested with the GPIO v2 uAPI which publishes realtime
+    timestamps has its events stamped with the realtime clock by the
+    kernel, and the timestamp is published as it is.  Otherwise the
+    kernel event timestamps are taken from the monotonic clock, and
+    realtime timestamps are approximated using the offset between the
+    realtime and monotonic clocks when the timestamp is published, so
+    they are shifted by any step of the realtime clock since the event.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to write
+
+    @retval EOK the timestamp was written successfully
+    @retval other error reported by VAR_Set()
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int WriteTimestampVar( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    VarObject var;
+    struct timespec ts;
+    uint64_t timestamp;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        timestamp = pGPIO->timestamp;
+
+        if ( ( pGPIO->timestampClock == CLOCK_REALTIME ) &&
+             ( pGPIO->realtimeEvents == false ) )
+        {
+            /* convert the monotonic timestamp to the realtime clock */
+            clock_gettime( CLOCK_REALTIME, &ts );
+            timestamp += ( (uint64_t)ts.tv_sec * NS_PER_SEC ) +
+                         (uint64_t)ts.tv_nsec;
+            timestamp -= GetMonotonicTime();
+        }
+
+        /* set the value of the timestamp variable */
+        var.val.ull = timestamp;
+        var.type = VARTYPE_UINT64;
+        var.len = sizeof(uint64_t);
+
+        /* write to the timestamp variable */
+        result = VAR_Set( pState->hVarServer,
+                          pGPIO->hTimestampVar,
+                          &var );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HandleVarSignals                                                          */
+/*!
+    Handle the pending signals from the variable server
+
+    The HandleVarSignals function reads all of the pending variable server
+    signals from the signal file descriptor and handles each of them.
+    The signals are read in batches.  Requests for polled inputs are
+    queued while a batch is handled, and are then read together, so
+    the polled inputs in each line bank are read with a single request
+    no matter how many of them were requested.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @retval EOK the signals were handled
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int HandleVarSignals( GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    struct signalfd_siginfo *pInfo;
+    ssize_t len;
+    size_t n;
+    size_t i;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+        pInfo = pState->sigInfo;
+
+        do
+        {
+            len = read( pState->sigfd, pInfo, sizeof( pState->sigInfo ) );
+            n = ( len > 0 ) ? (size_t)len / sizeof( *pInfo ) : 0;
+
+            for ( i = 0; i < n; i++ )
+            {
+                if ( QueuePolledInput( pState,
+                                       pInfo[i].ssi_signo,
+                                       pInfo[i].ssi_int ) != EOK )
+                {
+                    HandleVarSignal( pState,
+                                     pInfo[i].ssi_signo,
+                                     pInfo[i].ssi_int );
+                }
+            }
+
+            /* read the polled inputs requested in this batch */
+            FlushPolledInputs( pState );
+
+        } while ( n == SIGNAL_BATCH_SIZE );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  QueuePolledInput                                                          */
+/*!
+    Queue a request for a polled input
+
+    The QueuePolledInput function checks if a variable server signal is
+    a CALC request for a polled input which was requested in a line bank,
+    and if so, queues the input to be read when the current batch of
+    signals has been handled.  Repeated requests for the same input in
+    a batch are merged.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        sig
+            the signal received from the variable server
+
+    @param[in]
+        sigval
+            the value associated with the signal
+
+    @retval EOK the polled input request was queued
+    @retval ENOENT the signal is not a request for a bank polled input
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int QueuePolledInput( GPIOCtrlState *pState, int sig, int sigval )
+{
+    int result = EINVAL;
+    GPIO *pGPIO;
+
+    if ( pState != NULL )
+    {
+        result = ENOENT;
+
+        if ( sig == SIG_VAR_CALC )
+        {
+            pGPIO = FindGPIO( pState, (VAR_HANDLE)sigval );
+            if ( ( pGPIO != NULL ) &&
+                 ( pGPIO->pGroup == NULL ) &&
+                 ( pGPIO->inputMode == INPUT_MODE_LEVEL ) &&
+                 ( pGPIO->direction == GPIOD_LINE_DIRECTION_INPUT ) &&
+                 ( pGPIO->pBank != NULL ) &&
+                 ( pGPIO->pBank->requested == true ) )
+            {
+                if ( pGPIO->pollPending == false )
+                {
+                    pGPIO->pollPending = true;
+                    pGPIO->pNextPoll = pState->pFirstPoll;
+                    pState->pFirstPoll = pGPIO;
+                }
+
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FlushPolledInputs                                                         */
+/*!
+    Read the queued polled inputs
+
+    The FlushPolledInputs function reads all of the queued polled inputs
+    and writes their levels to their variables.  All of the inputs are
+    read at the same time, so each line bank is read at most once, and
+    its levels are fanned out to all of the requested inputs in the bank.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @retval EOK the queued polled inputs were updated
+    @retval EINVAL invalid arguments
+    @retval other error from the last input which could not be updated
+
+==============================================================================*/
+static int FlushPolledInputs( GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    GPIO *pGPIO;
+    uint64_t now;
+    int rc;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( pState->pFirstPoll != NULL )
+        {
+            now = GetMonotonicTime();
+
+            while ( pState->pFirstPoll != NULL )
+            {
+                pGPIO = pState->pFirstPoll;
+                pState->pFirstPoll = pGPIO->pNextPoll;
+                pGPIO->pNextPoll = NULL;
+                pGPIO->pollPending = false;
+
+                rc = UpdatePolledInput( pState, pGPIO, now );
+                if ( rc != EOK )
+                {
+                    result = rc;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HandleVarSignal                                                           */
+/*!
+    Handle a signal from the variable server
+
+    The HandleVarSignal function handles a signal from the variable server
+    such as one of the following:
+        - SIG_VAR_MODIFIED
+        - SIG_VAR_CALC
+        - SIG_VAR_PRINT
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state object
+
+    @param[in]
+        sig
+            the signal received from the variable server
+
+    @param[in]
+        sigval
+            the value associated with the signal
+
+    @retval EOK the signal was handled successfully
+    @retval ENOTSUP the signal was not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int HandleVarSignal( GPIOCtrlState *pState, int sig, int sigval )
+{
+    VAR_HANDLE hVar;
+    int fd = -1;
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        if( sig == SIG_VAR_MODIFIED )
+        {
+            /* get the handle of the variable which has changed */
+            hVar = (VAR_HANDLE)sigval;
+            UpdateOutput( hVar, pState );
+            result = EOK;
+        }
+        else if( sig == SIG_VAR_CALC )
+        {
+            hVar = (VAR_HANDLE)sigval;
+            UpdateInput( hVar, pState);
+            result = EOK;
+        }
+        else if ( sig == SIG_VAR_PRINT )
+        {
+            /* open a print session */
+            VAR_OpenPrintSession( state.hVarServer,
+                                  sigval,
+                                  &hVar,
+                                  &fd );
+
+            /* print the requested variable */
+            if ( hVar == pState->hStats )
+            {
+                PrintStats( pState, fd );
+            }
+            else if ( hVar == pState->hHistory )
+            {
+                PrintHistory( pState, fd );
+            }
+            else
+            {
+                PrintStatus( pState, fd );
+            }
+
+            /* Close the print session */
+            VAR_ClosePrintSession( state.hVarServer,
+                                   sigval,
+                                   fd );
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseChip                                                                 */
+/*!
+
+  Parse a GPIO chip definition
+
+    The ParseChip function is a callback function for the JSON_Iterate
+    function which parses a GPIO chip definition object.
+    The chip definition object is expected to look as follows:
+
+    { "chip": "chipname",
+      "lines": [<array of line objects>],
+      "encoders": [<array of encoder objects>],
+      "groups": [<array of line group objects>] }
+
+    The "encoders" and "groups" arrays are optional.
+
+    @param[in]
+       pNode
+            pointer to the chip node
+
+    @param[in]
+        arg
+            opaque pointer argument used for the gpioctrl state object
+
+    @retval EOK - the chip object was parsed successfully
+    @retval EINVAL - the chipe object could not be parsed
+
+==============================================================================*/
+static int ParseChip( JNode *pNode, void *arg )
+{
+    int result = EINVAL;
+    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
+
+    /* create the GPIOChip object */
+    if( CreateChip( pNode, pState ) != NULL )
+    {
+        /* create the GPIO lines in the GPIOChip object */
+        result = CreateLines( pNode, pState );
+
+        /* create the quadrature encoders in the GPIOChip object */
+        CreateEncoders( pNode, pState );
+
+        /* create the line groups in the GPIOChip object */
+        CreateGroups( pNode, pState );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CreateChip                                                                */
+/*!
+
+    Create a GPIO chip
+
+    The CreateChip function opens a libgpiod chip specified in the JSON
+    node.  The JSON Node is expected to contain a chip name specified
+    using the "chip" key.  A GPIOChip object is allocated on the heap to
+    manage the newly created chip.  The CreateChip function calls the
+    gpiod_chip_open_by_name function in the libgpiod library.
+    If the chip is opened and created successfully, it will be appended
+    to the list of GPIO chips in the GPIOCtrlState object.
+
+    @param[in]
+       pNode
+            pointer to the chip node containing the "chip" name key
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object containing the chip list
+            where the newly created GPIOChip object will be appended.
+
+    @retval pointer to the newly created GPIOChip
+    @retval NULL the GPIOChip could not be created
+
+==============================================================================*/
+static GPIOChip *CreateChip( JNode *pNode, GPIOCtrlState *pState )
+{
+    char *chipName;
+    struct gpiod_chip *pChip;
+    GPIOChip *pGPIOChip = NULL;
+    char buf[BUFSIZ];
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* get the chip name */
+        chipName = JSON_GetStr( pNode, "chip" );
+        if ( chipName != NULL )
+        {
+            /* build the chip name */
+            sprintf(buf, "/dev/%s", chipName );
+
+            /* try to open the chip */
+            pChip = gpiod_chip_open( buf );
+            if ( pChip != NULL )
+            {
+                /* allocate memory for the GPIOChip object */
+                pGPIOChip = calloc( 1, sizeof( GPIOChip ) );
+                if( pGPIOChip != NULL )
+                {
+                    pGPIOChip->name = chipName;
+                    pGPIOChip->pChip = pChip;
+
+                    /* insert the chip at the tail of the list */
+                    if( pState->pLastGPIOChip == NULL )
+                    {
+                        /* first chip found, point both first and last
+                         * pointers at it */
+                        pState->pLastGPIOChip = pGPIOChip;
+                        pState->pFirstGPIOChip = pGPIOChip;
+                    }
+                    else
+                    {
+                        pState->pLastGPIOChip->pNext = pGPIOChip;
+                        pState->pLastGPIOChip = pGPIOChip;
+                    }
+                }
+                else
+                {
+                    /* cloud not allocate memory for the GPIO Chip */
+                    /* clean up resources used by the chip */
+                    gpiod_chip_close( pChip );
+                }
+
+            }
+            else
+            {
+                printf("unable to open chip: %s\n", buf );
+            }
+        }
+        else
+        {
+            printf("chip name is NULL\n");
+        }
+    }
+
+    return pGPIOChip;
+}
+
+/*============================================================================*/
+/*  CreateLines                                                               */
+/*!
+
+    Create all the GPIO lines referenced in the JSON definition object
+
+    The CreateLines function iterates through all the lines specified
+    in the GPIO definition object for the current chip being processed.
+    For each line, a GPIO line object is created that associates a
+    variable handle with a gpiod_line object.
+
+    The JSON object is expected to contain a "line" attribute containing
+    an array of line definition objects.
+
+    @param[in]
+       pNode
+            pointer to the chip node containing the "lines" name key
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object containing a reference
+            to the GPIOChip object containing the GPIO line list
+            where the newly created GPIO line objects will be appended.
+
+    @retval EOK all the lines in the chip were successfully created
+    @retval ENOTSUP invalid JSON object specified in pNode
+    @retval EINVAL invalid arguments
+    @retval other error returned by JSON_Iterate
+
+==============================================================================*/
+static int CreateLines( JNode *pNode, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    JArray *pLines;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* find the lines */
+        pNode = JSON_Find( pNode, "lines" );
+        if( pNode != NULL )
+        {
+            /* confirm it is an array type */
+            if( pNode->type == JSON_ARRAY )
+            {
+                pLines = (JArray *)pNode;
+
+                /* iterate through the lines */
+                result = JSON_Iterate( pLines, ParseLine, (void *)pState );
+            }
+            else
+            {
+                /* JSON type is not supported */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLine                                                                 */
+/*!
+    Parse a GPIO line definition
+
+    The ParseLine function is a callback function for the JSON_Iterate
+    function which parses a GPIO line definition object.
+    The line definition object is expected to look as follows:
+
+    { "line": "<line number>",
+      "var": "<variable name>",
+      "active_state" : "<active state>",
+      "event": "<event_type>",
+      "direction": "<direction>",
+      "drive", "<drive type>",
+      "bias", "<bias type>"
+      }
+
+    @param[in]
+       pNode
+            pointer to the line node
+
+    @param[in]
+        arg
+            opaque pointer argument used for the gpioctrl state object
+
+    @retval EOK - the chip object was parsed successfully
+    @retval EINVAL - the chip object could not be parsed
+
+==============================================================================*/
+static int ParseLine( JNode *pNode, void *arg )
+{
+    int result = EINVAL;
+    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
+    GPIO *pGPIO;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* create a GPIO line */
+        pGPIO = CreateLine( pNode, pState );
+        if( pGPIO != NULL )
+        {
+            /* set the line direction */
+            ParseLineDirection( pGPIO, pNode, pState );
+
+            /* set the line active state */
+            ParseLineActiveState( pGPIO, pNode );
+
+            /* get the line event enable status */
+            ParseLineEvent( pGPIO, pNode );
+
+            /* get the variable update rate limit */
+            ParseLinePublish( pGPIO, pNode );
+
+            /* get the frequency measurement settings */
+            ParseLineFrequency( pGPIO, pNode, pState );
+
+            /* get the pulse width measurement settings */
+            ParseLinePulse( pGPIO, pNode );
+
+            /* get the pulse output settings */
+            ParseLineOneShot( pGPIO, pNode );
+
+            /* get the input debounce interval */
+            ParseLineDebounce( pGPIO, pNode );
+
+            /* get the polled input cache age */
+            ParseLineMaxAge( pGPIO, pNode );
+
+            /* get the event timestamp variable */
+            ParseLineTimestamp( pGPIO, pNode, pState );
+
+            /* set the line bias */
+            ParseLineBias( pGPIO, pNode );
+
+            /* set the line drive mode */
+            ParseLineDrive( pGPIO, pNode );
+
+            /* get the output write mode */
+            ParseLineForceWrite( pGPIO, pNode );
+
+            /* request (reserve) the line */
+            RequestLine( pGPIO, pState );
+
+            /* track monitored events */
+            if ( pGPIO->event_type != 0 )
+            {
+                /* index the line for the event loop */
+                AddEventIndex( pState, pGPIO );
+            }
+
+            /* set up the variable notification on the GPIO line */
+            SetupNotification( pGPIO, pState );
+
+            /* create a PWM if applicable */
+            if ( pGPIO->PWM == true )
+            {
+                CreatePWM( pState, pGPIO );
+            }
+            else if ( pGPIO->outputMode == OUTPUT_MODE_PATTERN )
+            {
+                /* start the initial output pattern */
+                StartPattern( pState, pGPIO );
+            }
+        }
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  RequestLine                                                               */
+/*!
+    Request the line from the gpiod library
+
+    The RequestLine function requests access to the line from the gpiod library
+    It sets up the gpio line direction, active state, bias, and drive mode,
+    as well as setting the value of the line if it is an output.
+
+    Polled inputs are added to a bank of polled inputs on the same chip,
+    and are requested together when the configuration has been processed,
+    so they can be read with a single request.
+
+    The settled level of an input debounced in userspace is read when it
+    is requested, and a debounced level input publishes it, so that the
+    first edge is compared against the real level of the line.
+
+    @param[in]
+       pGPIO
+            pointer to the GPIO line to request
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @retval EOK the line was successfully requested
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int RequestLine( GPIO *pGPIO, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    int rc;
+    bool request;
+    int value;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pState != NULL ) &&
+         ( pState->service != NULL ) )
+    {
+        /* set the consumer name.  The request flags were set from the
+         * line definition when it was parsed */
+        pGPIO->request.consumer = pState->service;
+
+        if( pGPIO->event_type != 0 )
+        {
+            /* if an event type is specified, we auomatically configure
+            the line as an input and set the request type to the specified
+            edge trigger */
+            pGPIO->request.request_type = pGPIO->event_type;
+        }
+
+        /* software PWM lines are requested together in line banks
+         * when the PWM scheduler is started, and hardware PWM lines
+         * are driven by their PWM controller */
+        request = ( pGPIO->PWM == false );
+
+        if ( ( pGPIO->event_type != 0 ) &&
+             ( ( pGPIO->debounceInterval > 0 ) ||
+               ( KernelRealtime( pGPIO ) == true ) ) )
+        {
+            /* try to have the kernel debounce the line or stamp its
+             * events with the realtime clock, otherwise fall back to
+             * the userspace debounce filter and timestamp conversion */
+            if ( RequestLineV2( pGPIO, pState ) == EOK )
+            {
+                pGPIO->kernelDebounce = ( pGPIO->debounceInterval > 0 );
+                request = false;
+                result = EOK;
+            }
+        }
+
+        if ( ( request == true ) &&
+             ( pGPIO->event_type == 0 ) &&
+             ( pGPIO->inputMode == INPUT_MODE_LEVEL ) &&
+             ( pGPIO->direction == GPIOD_LINE_DIRECTION_INPUT ) )
+        {
+            /* add the line to a bank of polled inputs on the same chip */
+            result = AddBankLine( &pState->pFirstInputBank,
+                                  pState->pLastGPIOChip,
+                                  pGPIO );
+            request = ( result != EOK );
+        }
+
+        if ( request == true )
+        {
+            value = pGPIO->value;
+
+            rc = gpiod_line_request( pGPIO->pLine,
+                                     &pGPIO->request,
+                                     value );
+
+            result = ( rc == -1 ) ? errno : EOK;
+
+            if ( ( result == EOK ) &&
+                 ( pGPIO->event_type != 0 ) &&
+                 ( pGPIO->debounceInterval > 0 ) )
+            {
+                /* the debounce filter compares the edges of the line
+                 * with its settled level */
+                value = ReadLineLevel( pGPIO );
+                pGPIO->value = ( value > 0 ) ? 1 : 0;
+
+                if ( pGPIO->inputMode == INPUT_MODE_LEVEL )
+                {
+                    /* publish the initial level of the input */
+                    PublishValue( pState,
+                                  pGPIO,
+                                  pGPIO->value,
+                                  GetMonotonicTime() );
+                }
+            }
+        }
+        else if ( ( pGPIO->kernelDebounce == false ) &&
+                  ( pGPIO->pBank == NULL ) )
+        {
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RequestLineV2                                                             */
+/*!
+    Request an edge triggered input line with the GPIO v2 uAPI
+
+    The RequestLineV2 function requests an edge triggered input line
+    directly from the GPIO character device using the v2 uAPI, so the
+    line debounce period can be applied by the kernel, and the line
+    events can be stamped with the realtime clock.  libgpiod 1.6 cannot
+    express either.  Bounces are then filtered before they reach
+    userspace, and realtime event timestamps are exact.
+
+    The line events are read from the returned line file descriptor,
+    which is stored in the GPIO object.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to request
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state
+
+    @retval EOK the line was requested
+    @retval ENOTSUP the GPIO v2 uAPI is not available
+    @retval EINVAL invalid arguments
+    @retval other error reported by the GPIO character device
+
+==============================================================================*/
+static int RequestLineV2( GPIO *pGPIO, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+#ifdef GPIO_V2_GET_LINE_IOCTL
+    struct gpio_v2_line_request req;
+    struct gpio_v2_line_config *pConfig;
+    char buf[BUFSIZ];
+    int fd;
+    int rc;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pState != NULL ) &&
+         ( pState->pLastGPIOChip != NULL ) &&
+         ( pState->service != NULL ) )
+    {
+        memset( &req, 0, sizeof( req ) );
+        req.offsets[0] = pGPIO->line_num;
+        req.num_lines = 1;
+        strncpy( req.consumer, pState->service, GPIO_MAX_NAME_SIZE - 1 );
+
+        /* edge triggered input */
+        pConfig = &req.config;
+        pConfig->flags = GPIO_V2_LINE_FLAG_INPUT;
+        if ( pGPIO->event_type != GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE )
+        {
+            pConfig->flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+        }
+
+        if ( pGPIO->event_type != GPIOD_LINE_REQUEST_EVENT_RISING_EDGE )
+        {
+            pConfig->flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        }
+
+        if ( pGPIO->request.flags & GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW )
+        {
+            pConfig->flags |= GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+        }
+
+        if ( pGPIO->request.flags & GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP )
+        {
+            pConfig->flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+        }
+        else if ( pGPIO->request.flags &
+                  GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_DOWN )
+        {
+            pConfig->flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+        }
+        else if ( pGPIO->request.flags &
+                  GPIOD_LINE_REQUEST_FLAG_BIAS_DISABLE )
+        {
+            pConfig->flags |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;
+        }
+
+        if ( KernelRealtime( pGPIO ) == true )
+        {
+            /* have the kernel stamp the events with the realtime clock */
+            pConfig->flags |= GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME;
+        }
+
+        if ( pGPIO->debounceInterval > 0 )
+        {
+            /* kernel debounce period */
+            pConfig->num_attrs = 1;
+            pConfig->attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+            pConfig->attrs[0].attr.debounce_period_us =
+                pGPIO->debounceInterval / NS_PER_US;
+            pConfig->attrs[0].mask = 1;
+        }
+
+        sprintf( buf, "/dev/%s", pState->pLastGPIOChip->name );
+        fd = open( buf, O_RDWR | O_CLOEXEC );
+        if ( fd != -1 )
+        {
+            rc = ioctl( fd, GPIO_V2_GET_LINE_IOCTL, &req );
+            if ( ( rc != 0 ) &&
+                 ( errno == EINVAL ) &&
+                 ( pGPIO->debounceInterval > 0 ) &&
+                 ( pConfig->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME ) )
+            {
+                /* kernels before 5.11 cannot stamp the events with the
+                 * realtime clock, so keep the kernel debounce and
+                 * convert the timestamps instead */
+                pConfig->flags &= ~GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME;
+                rc = ioctl( fd, GPIO_V2_GET_LINE_IOCTL, &req );
+            }
+
+            if ( rc == 0 )
+            {
+                pGPIO->lineFd = req.fd;
+                pGPIO->realtimeEvents =
+                    ( pConfig->flags &
+                      GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME ) != 0;
+                result = EOK;
+            }
+            else
+            {
+                result = errno;
+            }
+
+            close( fd );
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+#else
+    result = ENOTSUP;
+#endif
+
+    return result;
+}
+
+/*============================================================================*/
+/*  KernelRealtime                                                            */
+/*!
+    Check if the kernel should stamp the line events with the realtime clock
+
+    The KernelRealtime function checks if a line publishes realtime
+    event timestamps, and only uses its event timestamps for publishing.
+    Such a line is requested with the GPIO v2 uAPI so the kernel stamps
+    its events with the realtime clock.  The frequency, pulse width and
+    encoder inputs measure their edges against the monotonic clock, and
+    keep monotonic event timestamps.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to check
+
+    @retval true the line events should be stamped with the realtime clock
+    @retval false the line events should be stamped with the monotonic clock
+
+==============================================================================*/
+static bool KernelRealtime( GPIO *pGPIO )
+{
+    bool result = false;
+
+    if ( pGPIO != NULL )
+    {
+        result = ( pGPIO->timestampClock == CLOCK_REALTIME ) &&
+                 ( pGPIO->hTimestampVar != VAR_INVALID ) &&
+                 ( ( pGPIO->inputMode == INPUT_MODE_LEVEL ) ||
+                   ( pGPIO->inputMode == INPUT_MODE_COUNTER ) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupPrintNotifications                                                   */
+/*!
+    Set up a render notifications for the GPIO controller
+
+    The SetupPrintNotifications function sets up the render notifications
+    for the GPIO controller info, statistics and event history variables.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state which contains a handle
+            to the variable server for requesting the notifications.
+
+    @retval EOK the notifications were successfully requested
+    @retval ENOENT a requested variable was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetupPrintNotifications( GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    int rc;
+
+    if ( pState != NULL )
+    {
+        result = SetupPrintNotification( pState,
+                                         "/SYS/GPIOCTRL/INFO",
+                                         &pState->hInfo );
+
+        rc = SetupPrintNotification( pState,
+                                     "/SYS/GPIOCTRL/STATS",
+                                     &pState->hStats );
+        if ( rc != EOK )
+        {
+            result = rc;
+        }
+
+        rc = SetupPrintNotification( pState,
+                                     "/SYS/GPIOCTRL/HISTORY",
+                                     &pState->hHistory );
+        if ( rc != EOK )
+        {
+            result = rc;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupPrintNotification                                                    */
+/*!
+    Set up a render notification for a GPIO controller variable
+
+    The SetupPrintNotification function looks up the specified variable
+    and sets up a render notification for it.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state which contains a handle
+            to the variable server for requesting the notification.
+
+    @param[in]
+        name
+            name of the variable to request the notification for
+
+    @param[out]
+        phVar
+            pointer to the location to store the variable handle
+
+    @retval EOK the notification was successfully requested
+    @retval ENOENT the requested variable was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetupPrintNotification( GPIOCtrlState *pState,
+                                   char *name,
+                                   VAR_HANDLE *phVar )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+
+    if ( ( pState != NULL ) &&
+         ( name != NULL ) &&
+         ( phVar != NULL ) )
+    {
+        hVar = VAR_FindByName( pState->hVarServer, name );
+        *phVar = hVar;
+        if( hVar != VAR_INVALID )
+        {
+            result = VAR_Notify( pState->hVarServer,
+                                 hVar,
+                                 NOTIFY_PRINT );
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupNotification                                                         */
+/*!
+    Set up a variable server notification for the GPIO line
+
+    The SetupNotification function requests a notification from the variable
+    server for the variable associated with the specified GPIO line.
+
+    GPIO lines in INPUT mode will set up a CALC notification to force a query
+    of the input line when the variable is requested.
+
+    GPIO lines in OUTPUT mode will set up a MODIFIED notification to force
+    the output to be changed when the variable is modified.
+
+    It is assumed that the line direction has already been initialized when
+    this function is called.
+
+    @param[in]
+       pGPIO
+            pointer to the GPIO line to set up a notification for
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state which contains a handle
+            to the variable server for requesting the notification.
+
+    @retval EOK the notification was successfully requested
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SetupNotification( GPIO *pGPIO, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pState != NULL ) )
+    {
+        if ( ( pGPIO->direction == GPIOD_LINE_DIRECTION_INPUT ) &&
+             ( ( pGPIO->event_type == 0 ) ||
+               ( pGPIO->inputMode != INPUT_MODE_LEVEL ) ) )
+        {
+            result = VAR_Notify( pState->hVarServer,
+                                 pGPIO->hVar,
+                                 NOTIFY_CALC );
+        }
+        else if ( pGPIO->direction == GPIOD_LINE_DIRECTION_OUTPUT )
+        {
+            result = VAR_Notify( pState->hVarServer,
+                                 pGPIO->hVar,
+                                 NOTIFY_MODIFIED );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CreateLine                                                                */
+/*!
+    Create a GPIO line definition
+
+    The CreateLine function creates a GPIO line object which links
+    a varaible handle with a gpiod_line object from the libgpiod
+    library
+
+    The pNode is expected to point to a JSON object which contains
+    the line number and variable name as follows:
+
+    "line": "<line number>",
+    "var": "<variable name>",
+
+    @param[in]
+        pNode
+            pointer to the line node
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object which contains
+            a reference to the variable server, and the gpiod_chip
+            object which specifies the chip that the owns this line.
+
+    @retval pointer to the GPIO line object that was created and added to the
+            GPIO line list for the chip we are currently processing
+    @retval NULL the GPIO line could not be created
+
+==============================================================================*/
+static GPIO *CreateLine( JNode *pNode, GPIOCtrlState *pState )
+{
+    GPIO *pGPIOLine = NULL;
+    VAR_HANDLE hVar = VAR_INVALID;
+    char *line_str;
+    unsigned int line_num;
+    char *varname;
+    GPIOChip *pGPIOChip;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) &&
+         ( pState->pLastGPIOChip != NULL ) )
+    {
+        /* get a pointer to the GPIOChip object we are currently processing */
+        pGPIOChip = pState->pLastGPIOChip;
+
+        /* get a handle to the variable associated with the GPIO line */
+        hVar = GetVarHandle( pState->hVarServer, pNode, &varname );
+        if( hVar != VAR_INVALID )
+        {
+            /* get the "line" attribute from the GPIO line definition object */
+            line_str = JSON_GetStr( pNode, "line" );
+            if ( line_str != NULL )
+            {
+                /* convert the line number to an integer */
+                line_num = strtoul( line_str, NULL, 0 );
+
+                /* create the GPIO line object */
+                pGPIOLine = AddLine( pGPIOChip, line_num, hVar, varname );
+            }
+            else
+            {
+                printf("cannot get line\n");
+            }
+        }
+        else
+        {
+            printf("Unable to Get var handle\n");
+        }
+    }
+
+    return pGPIOLine;
+}
+
+/*============================================================================*/
+/*  AddLine                                                                   */
+/*!
+    Add a GPIO line object to a GPIO chip
+
+    The AddLine function creates a GPIO line object which links
+    a variable handle with a gpiod_line object from the libgpiod
+    library, and appends it to the line list of the GPIO chip.
+
+    @param[in]
+        pGPIOChip
+            pointer to the GPIO chip which owns the line
+
+    @param[in]
+        line_num
+            offset of the line on the GPIO chip
+
+    @param[in]
+        hVar
+            handle to the variable associated with the line
+
+    @param[in]
+        varname
+            name of the variable associated with the line
+
+    @retval pointer to the GPIO line object that was created
+    @retval NULL the GPIO line could not be created
+
+==============================================================================*/
+static GPIO *AddLine( GPIOChip *pGPIOChip,
+                      unsigned int line_num,
+                      VAR_HANDLE hVar,
+                      char *varname )
+{
+    GPIO *pGPIOLine = NULL;
+    struct gpiod_line *pLine;
+
+    if ( pGPIOChip != NULL )
+    {
+        /* get a handle to the GPIO line from the GPIOD library */
+        pLine = gpiod_chip_get_line( pGPIOChip->pChip, line_num );
+        if( pLine != NULL )
+        {
+            /* allocate memory for the GPIO line object */
+            pGPIOLine = calloc( 1, sizeof( GPIO ) );
+            if( pGPIOLine != NULL )
+            {
+                /* store the variable handle */
+                pGPIOLine->hVar = hVar;
+
+                /* store the variable name */
+                pGPIOLine->name = varname;
+
+                /* store a pointer to the gpiod_line */
+                pGPIOLine->pLine = pLine;
+
+                /* store the line number */
+                pGPIOLine->line_num = line_num;
+
+                /* the line has no GPIO v2 uAPI line request */
+                pGPIOLine->lineFd = -1;
+
+                /* add the GPIO line to the line list */
+                if ( pGPIOChip->pLastLine == NULL )
+                {
+                    pGPIOChip->pFirstLine = pGPIOLine;
+                    pGPIOChip->pLastLine = pGPIOLine;
+                }
+                else
+                {
+                    pGPIOChip->pLastLine->pNext = pGPIOLine;
+                    pGPIOChip->pLastLine = pGPIOLine;
+                }
+            }
+            else
+            {
+                /* memory allocation failed */
+                /* clean up the libgpiod resources */
+                gpiod_line_release( pLine );
+            }
+        }
+        else
+        {
+            printf("failed to create line %d\n", line_num );
+        }
+    }
+
+    return pGPIOLine;
+}
+
+/*============================================================================*/
+/*  RemoveLine                                                                */
+/*!
+    Remove a GPIO line object from a GPIO chip
+
+    The RemoveLine function undoes AddLine for a line which could not be
+    set up.  It removes the line from the line list of the GPIO chip and
+    from the event loop index, releases the line, and frees the GPIO line
+    object.
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @param[in]
+        pGPIOChip
+            pointer to the GPIO chip which owns the line
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO line object to remove
+
+==============================================================================*/
+static void RemoveLine( GPIOCtrlState *pState,
+                        GPIOChip *pGPIOChip,
+                        GPIO *pGPIO )
+{
+    GPIO *pPrev = NULL;
+    GPIO *p;
+    size_t i;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIOChip != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        /* remove the line from the line list */
+        p = pGPIOChip->pFirstLine;
+        while ( ( p != NULL ) && ( p != pGPIO ) )
+        {
+            pPrev = p;
+            p = p->pNext;
+        }
+
+        if ( p != NULL )
+        {
+            if ( pPrev == NULL )
+            {
+                pGPIOChip->pFirstLine = pGPIO->pNext;
+            }
+            else
+            {
+                pPrev->pNext = pGPIO->pNext;
+            }
+
+            if ( pGPIOChip->pLastLine == pGPIO )
+            {
+                pGPIOChip->pLastLine = pPrev;
+            }
+        }
+
+        /* remove the line from the event loop index */
+        for ( i = 0; i < pState->nEventTable; i++ )
+        {
+            if ( pState->pEventTable[i] == pGPIO )
+            {
+                pState->pEventTable[i] = NULL;
+            }
+        }
+
+        if ( pGPIO->lineFd != -1 )
+        {
+            close( pGPIO->lineFd );
+        }
+
+        gpiod_line_release( pGPIO->pLine );
+        free( pGPIO->pHistory );
+        free( pGPIO );
+    }
+}
+
+/*============================================================================*/
+/*  CreateEncoders                                                            */
+/*!
+    Create all the quadrature encoders referenced in the JSON definition object
+
+    The CreateEncoders function iterates through all the quadrature
+    encoders specified in the "encoders" array of the GPIO definition
+    object for the current chip being processed.  The "encoders" array
+    is optional.
+
+    @param[in]
+       pNode
+            pointer to the chip node
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @retval EOK all the encoders in the chip were successfully created
+    @retval ENOTSUP invalid JSON object specified in pNode
+    @retval EINVAL invalid arguments
+    @retval other error returned by JSON_Iterate
+
+==============================================================================*/
+static int CreateEncoders( JNode *pNode, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        result = EOK;
+
+        /* find the encoders */
+        pNode = JSON_Find( pNode, "encoders" );
+        if( pNode != NULL )
+        {
+            if( pNode->type == JSON_ARRAY )
+            {
+                /* iterate through the encoders */
+                result = JSON_Iterate( (JArray *)pNode,
+                                       ParseEncoder,
+                                       (void *)pState );
+            }
+            else
+            {
+                /* JSON type is not supported */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseEncoder                                                              */
+/*!
+    Parse a quadrature encoder definition
+
+    The ParseEncoder function is a callback function for the JSON_Iterate
+    function which parses a quadrature encoder definition object.
+    The encoder definition object is expected to look as follows:
+
+    { "a": "<line number>", "b": "<line number>", "var": "<variable name>" }
+
+    The "bias", "active_state", "debounce_us", "publish_interval_ms",
+    "max_rate", "timestamp_var" and "timestamp_clock" attributes are also
+    supported, and apply to both channels.
+
+    Both channels are requested as inputs generating events on both edges.
+    The encoder position is published to the variable as a signed count
+    of quadrature transitions.  No encoder is created unless both
+    channels are given and both can be requested.
+
+    @param[in]
+       pNode
+            pointer to the encoder node
+
+    @param[in]
+        arg
+            opaque pointer argument used for the gpioctrl state object
+
+    @retval EOK the encoder object was parsed successfully
+    @retval ENOENT the encoder variable was not found
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL the encoder object could not be parsed
+
+==============================================================================*/
+static int ParseEncoder( JNode *pNode, void *arg )
+{
+    int result = EINVAL;
+    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
+    Encoder *pEncoder;
+    VAR_HANDLE hVar;
+    char *varname;
+    int a;
+    int b;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* get a handle to the variable associated with the encoder */
+        hVar = GetVarHandle( pState->hVarServer, pNode, &varname );
+        if ( ( hVar != VAR_INVALID ) &&
+             ( ( JSON_GetStr( pNode, "a" ) == NULL ) ||
+               ( JSON_GetStr( pNode, "b" ) == NULL ) ) )
+        {
+            printf("encoder %s needs both the a and b channels\n", varname );
+        }
+        else if ( hVar != VAR_INVALID )
+        {
+            pEncoder = calloc( 1, sizeof( Encoder ) );
+            if ( pEncoder != NULL )
+            {
+                /* create the encoder channels */
+                pEncoder->pA = CreateEncoderLine( pNode,
+                                                  "a",
+                                                  pEncoder,
+                                                  hVar,
+                                                  varname,
+                                                  pState );
+                if ( pEncoder->pA != NULL )
+                {
+                    pEncoder->pB = CreateEncoderLine( pNode,
+                                                      "b",
+                                                      pEncoder,
+                                                      hVar,
+                                                      varname,
+                                                      pState );
+                    if ( pEncoder->pB == NULL )
+                    {
+                        /* an encoder cannot be decoded from one channel */
+                        RemoveLine( pState,
+                                    pState->pLastGPIOChip,
+                                    pEncoder->pA );
+                        pEncoder->pA = NULL;
+                    }
+                }
+
+                if ( ( pEncoder->pA != NULL ) &&
+                     ( pEncoder->pB != NULL ) )
+                {
+                    /* the encoder variable is read via channel A */
+                    SetupNotification( pEncoder->pA, pState );
+
+                    /* get the initial encoder state */
+                    a = ReadLineLevel( pEncoder->pA );
+                    b = ReadLineLevel( pEncoder->pB );
+                    pEncoder->pA->value = ( a > 0 ) ? 1 : 0;
+                    pEncoder->pB->value = ( b > 0 ) ? 1 : 0;
+                    pEncoder->state = ( pEncoder->pA->value << 1 ) |
+                                      pEncoder->pB->value;
+
+                    /* add the encoder to the encoder list */
+                    pEncoder->pNext = pState->pFirstEncoder;
+                    pState->pFirstEncoder = pEncoder;
+
+                    result = EOK;
+                }
+                else
+                {
+                    free( pEncoder );
+                }
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            printf("Unable to Get var handle\n");
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CreateEncoderLine                                                         */
+/*!
+    Create a quadrature encoder channel
+
+    The CreateEncoderLine function creates the GPIO line object for one
+    channel of a quadrature encoder, requests it as an input which
+    generates events on both edges, and adds it to the event loop.
+    If the line cannot be requested, it is removed again.
+
+    @param[in]
+       pNode
+            pointer to the encoder node
+
+    @param[in]
+        channel
+            name of the attribute containing the channel line number
+
+    @param[in]
+        pEncoder
+            pointer to the encoder which owns the channel
+
+    @param[in]
+        hVar
+            handle to the encoder variable
+
+    @param[in]
+        varname
+            name of the encoder variable
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @retval pointer to the GPIO line object that was created
+    @retval NULL the GPIO line could not be created
+
+==============================================================================*/
+static GPIO *CreateEncoderLine( JNode *pNode,
+                                char *channel,
+                                Encoder *pEncoder,
+                                VAR_HANDLE hVar,
+                                char *varname,
+                                GPIOCtrlState *pState )
+{
+    GPIO *pGPIO = NULL;
+    char *line_str;
+
+    if ( ( pNode != NULL ) &&
+         ( channel != NULL ) &&
+         ( pEncoder != NULL ) &&
+         ( pState != NULL ) )
+    {
+        line_str = JSON_GetStr( pNode, channel );
+        if ( line_str != NULL )
+        {
+            pGPIO = AddLine( pState->pLastGPIOChip,
+                             strtoul( line_str, NULL, 0 ),
+                             hVar,
+                             varname );
+            if ( pGPIO != NULL )
+            {
+                pGPIO->pEncoder = pEncoder;
+                pGPIO->inputMode = INPUT_MODE_ENCODER;
+                pGPIO->varType = GetVarType( pState, hVar );
+                pGPIO->direction = GPIOD_LINE_DIRECTION_INPUT;
+                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
+
+                /* get the channel settings */
+                ParseLineActiveState( pGPIO, pNode );
+                ParseLinePublish( pGPIO, pNode );
+                ParseLineDebounce( pGPIO, pNode );
+                ParseLineTimestamp( pGPIO, pNode, pState );
+                ParseLineBias( pGPIO, pNode );
+
+                /* request (reserve) the line, and index it for the
+                 * event loop */
+                if ( ( RequestLine( pGPIO, pState ) != EOK ) ||
+                     ( AddEventIndex( pState, pGPIO ) != EOK ) )
+                {
+                    printf( "unable to request encoder channel %s\n",
+                            channel );
+                    RemoveLine( pState, pState->pLastGPIOChip, pGPIO );
+                    pGPIO = NULL;
+                }
+            }
+        }
+        else
+        {
+            printf("encoder channel %s not specified\n", channel );
+        }
+    }
+
+    return pGPIO;
+}
+
+/*============================================================================*/
+/*  CreateGroups                                                              */
+/*!
+    Create all the line groups referenced in the JSON definition object
+
+    The CreateGroups function iterates through all the line groups
+    specified in the "groups" array of the GPIO definition object for the
+    current chip being processed.  The "groups" array is optional.
+
+    @param[in]
+       pNode
+            pointer to the chip node
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @retval EOK all the line groups in the chip were successfully created
+    @retval ENOTSUP invalid JSON object specified in pNode
+    @retval EINVAL invalid arguments
+    @retval other error returned by JSON_Iterate
+
+==============================================================================*/
+static int CreateGroups( JNode *pNode, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        result = EOK;
+
+        /* find the line groups */
+        pNode = JSON_Find( pNode, "groups" );
+        if( pNode != NULL )
+        {
+            if( pNode->type == JSON_ARRAY )
+            {
+                /* iterate through the line groups */
+                result = JSON_Iterate( (JArray *)pNode,
+                                       ParseGroup,
+                                       (void *)pState );
+            }
+            else
+            {
+                /* JSON type is not supported */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseGroup                                                                */
+/*!
+    Parse a line group definition
+
+    The ParseGroup function is a callback function for the JSON_Iterate
+    function which parses a line group definition object.
+    The line group definition object is expected to look as follows:
+
+    { "var": "<variable name>",
+      "direction": "output" | "input",
+      "lines": [ { "line": "<line number>" }, ... ] }
+
+    The first line in the "lines" array carries the least significant
+    bit of the variable value.  If the direction is not specified, it is
+    assumed to be "output".  The "active_state", "bias", "drive" and
+    "force_write" attributes are also supported, and apply to all of the
+    lines.
+    Input groups also support the "event", "publish_interval_ms",
+    "max_rate", "timestamp_var" and "timestamp_clock" attributes.
+
+    The lines are requested together, so the whole group value is
+    written or read with a single request.  If the group cannot be
+    created, its lines are removed again and the group is discarded.
+
+    @param[in]
+       pNode
+            pointer to the line group node
+
+    @param[in]
+        arg
+            opaque pointer argument used for the gpioctrl state object
+
+    @retval EOK the line group object was parsed successfully
+    @retval ENOENT the line group variable was not found
+    @retval ENOTSUP the line group definition is not supported
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL the line group object could not be parsed
+
+==============================================================================*/
+static int ParseGroup( JNode *pNode, void *arg )
+{
+    int result = EINVAL;
+    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
+    LineGroup *pGroup;
+    JNode *pLines;
+    VAR_HANDLE hVar;
+    char *varname;
+    char *direction;
+
+    if ( ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* get a handle to the variable associated with the group */
+        hVar = GetVarHandle( pState->hVarServer, pNode, &varname );
+        if ( hVar != VAR_INVALID )
+        {
+            pGroup = calloc( 1, sizeof( LineGroup ) );
+            if ( pGroup != NULL )
+            {
+                pGroup->hVar = hVar;
+                pGroup->name = varname;
+                pGroup->varType = GetVarType( pState, hVar );
+                pGroup->pGPIOChip = pState->pLastGPIOChip;
+
+                /* get the "direction" attribute */
+                direction = JSON_GetStr( pNode, "direction" );
+                if ( ( direction == NULL ) ||
+                     ( strcmp( direction, "output" ) == 0 ) )
+                {
+                    pGroup->direction = GPIOD_LINE_DIRECTION_OUTPUT;
+                    result = EOK;
+                }
+                else if ( strcmp( direction, "input" ) == 0 )
+                {
+                    pGroup->direction = GPIOD_LINE_DIRECTION_INPUT;
+                    result = EOK;
+                }
+                else
+                {
+                    /* unsupported group direction */
+                    result = ENOTSUP;
+                }
+
+                if ( result == EOK )
+                {
+                    /* create the group lines */
+                    pLines = JSON_Find( pNode, "lines" );
+                    if ( ( pLines != NULL ) &&
+                         ( pLines->type == JSON_ARRAY ) )
+                    {
+                        result = JSON_Iterate( (JArray *)pLines,
+                                               ParseGroupLine,
+                                               (void *)pGroup );
+                    }
+                    else
+                    {
+                        result = ENOTSUP;
+                    }
+                }
+
+                if ( result == EOK )
+                {
+                    /* request (reserve) the group lines */
+                    result = RequestGroup( pState, pGroup, pNode );
+                }
+
+                if ( result == EOK )
+                {
+                    if ( pGroup->nLines > 0 )
+                    {
+                        /* the group variable is handled via its first
+                         * line */
+                        SetupNotification( pGroup->pLines[0], pState );
+                    }
+
+                    /* add the group to the group list */
+                    pGroup->pNext = pState->pFirstGroup;
+                    pState->pFirstGroup = pGroup;
+                }
+                else
+                {
+                    printf("unable to create line group %s\n", varname );
+                    DiscardGroup( pState, pGroup );
+                }
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            printf("Unable to Get var handle\n");
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseGroupLine                                                            */
+/*!
+    Parse a line group member definition
+
+    The ParseGroupLine function is a callback function for the JSON_Iterate
+    function which creates the GPIO line object for the next member of a
+    line group.  The member definition object is expected to look as
+    follows:
+
+    { "line": "<line number>" }
+
+    @param[in]
+       pNode
+            pointer to the line group member node
+
+    @param[in]
+        arg
+            opaque pointer argument used for the line group
+
+    @retval EOK the member was added to the line group
+    @retval E2BIG the line group is full
+    @retval ENOMEM the GPIO line could not be created
+    @retval EINVAL the member object could not be parsed
+
+==============================================================================*/
+static int ParseGroupLine( JNode *pNode, void *arg )
+{
+    int result = EINVAL;
+    LineGroup *pGroup = (LineGroup *)arg;
+    GPIO *pGPIO;
+    char *line_str;
+
+    if ( ( pNode != NULL ) &&
+         ( pGroup != NULL ) )
+    {
+        line_str = JSON_GetStr( pNode, "line" );
+        if ( line_str == NULL )
+        {
+            printf("group line not specified\n");
+        }
+        else if ( pGroup->nLines >= GPIOD_LINE_BULK_MAX_LINES )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            pGPIO = AddLine( pGroup->pGPIOChip,
+                             strtoul( line_str, NULL, 0 ),
+                             pGroup->hVar,
+                             pGroup->name );
+            if ( pGPIO != NULL )
+            {
+                pGPIO->pGroup = pGroup;
+                pGPIO->groupBit = pGroup->nLines;
+                pGroup->pLines[pGroup->nLines++] = pGPIO;
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RequestGroup                                                              */
+/*!
+    Request the lines of a line group
+
+    The RequestGroup function configures all of the lines of a line group
+    from the group definition, adds them to the line bank of the group,
+    and requests them together.  The lines of an output group are set
+    from the initial value of the group variable.  The initial value of
+    an input group is read and published, and the lines of an input
+    group which generates events are added to the event loop.
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @param[in]
+        pGroup
+            pointer to the line group to request
+
+    @param[in]
+       pNode
+            pointer to the line group node
+
+    @retval EOK the line group was requested
+    @retval ENOMEM the line bank could not be allocated
+    @retval EINVAL invalid arguments
+    @retval other error requesting the line bank
+
+==============================================================================*/
+static int RequestGroup( GPIOCtrlState *pState,
+                         LineGroup *pGroup,
+                         JNode *pNode )
+{
+    int result = EINVAL;
+    GPIO *pGPIO;
+    int i;
+
+    if ( ( pState != NULL ) &&
+         ( pGroup != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        result = EOK;
+
+        if ( pGroup->direction == GPIOD_LINE_DIRECTION_OUTPUT )
+        {
+            /* get the initial group value */
+            (void)GetVarInteger( pState, pGroup->hVar, &pGroup->value );
+        }
+
+        for ( i = 0; ( i < pGroup->nLines ) && ( result == EOK ); i++ )
+        {
+            pGPIO = pGroup->pLines[i];
+            pGPIO->direction = pGroup->direction;
+            pGPIO->request.consumer = pState->service;
+            pGPIO->request.request_type =
+                ( pGroup->direction == GPIOD_LINE_DIRECTION_OUTPUT )
+                    ? GPIOD_LINE_REQUEST_DIRECTION_OUTPUT
+                    : GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+            pGPIO->value = ( pGroup->value >> pGPIO->groupBit ) & 1;
+
+            /* apply the group settings to the line */
+            ParseLineActiveState( pGPIO, pNode );
+            ParseLineBias( pGPIO, pNode );
+            ParseLineDrive( pGPIO, pNode );
+            ParseLineForceWrite( pGPIO, pNode );
+
+            if ( pGroup->direction == GPIOD_LINE_DIRECTION_INPUT )
+            {
+                /* apply the group input settings to the line */
+                ParseLineEvent( pGPIO, pNode );
+                ParseLinePublish( pGPIO, pNode );
+                ParseLineTimestamp( pGPIO, pNode, pState );
+
+                if ( pGPIO->event_type != 0 )
+                {
+                    pGPIO->request.request_type = pGPIO->event_type;
+                }
+            }
+
+            result = AddBankLine( &pGroup->pBank,
+                                  pGroup->pGPIOChip,
+                                  pGPIO );
+        }
+
+        if ( result == EOK )
+        {
+            /* request the group lines together */
+            result = RequestBanks( pGroup->pBank );
+        }
+
+        if ( ( result == EOK ) &&
+             ( pGroup->direction == GPIOD_LINE_DIRECTION_INPUT ) )
+        {
+            for ( i = 0; i < pGroup->nLines; i++ )
+            {
+                if ( pGroup->pLines[i]->event_type != 0 )
+                {
+                    /* index the line for the event loop */
+                    AddEventIndex( pState, pGroup->pLines[i] );
+                }
+            }
+
+            /* publish the initial group value */
+            result = UpdateGroupInput( pState, pGroup );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DiscardGroup                                                              */
+/*!
+    Discard a line group which could not be created
+
+    The DiscardGroup function removes the lines of a line group which
+    could not be created from their GPIO chip and the event loop index,
+    releases them, and frees the line bank of the group and the group
+    itself.  The group must not have been added to the group list.
+
+    @param[in]
+        pState
+            pointer to the gpioctrl state object
+
+    @param[in]
+        pGroup
+            pointer to the line group to discard
+
+==============================================================================*/
+static void DiscardGroup( GPIOCtrlState *pState, LineGroup *pGroup )
+{
+    int i;
+
+    if ( ( pState != NULL ) &&
+         ( pGroup != NULL ) )
+    {
+        for ( i = 0; i < pGroup->nLines; i++ )
+        {
+            RemoveLine( pState, pGroup->pGPIOChip, pGroup->pLines[i] );
+        }
+
+        FreeBanks( &pGroup->pBank );
+        free( pGroup );
+    }
+}
+
+/*============================================================================*/
+/*  GetVarHandle                                                              */
+/*!
+    Get the variable handle for the GPIO line
+
+    The GetVarHandle function looks up the variable handle for the variable
+    specified by the "var" attribute in the GPIO line definition.
+
+    @param[in]
+        hVarServer
+            handle to the variable server to query
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the "var" attribute
+
+    @param[out]
+        ppName
+            pointer to the location to store a pointer to the variable name
+
+    @retval handle of the specified variable
+    @retval VAR_INVALID if the variable was not found
+
+==============================================================================*/
+static VAR_HANDLE GetVarHandle( VARSERVER_HANDLE hVarServer,
+                                JNode *pNode,
+                                char **ppName )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+    char *varname;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pNode != NULL ) &&
+         ( ppName != NULL ) )
+    {
+        varname = JSON_GetStr( pNode, "var" );
+        if( varname != NULL )
+        {
+            hVar = VAR_FindByName( hVarServer, varname );
+            if( hVar != VAR_INVALID )
+            {
+                /* store a pointer to the variable name */
+                *ppName = varname;
+            }
+        }
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  ParseLineDirection                                                        */
+/*!
+    Parse the GPIO definition to set the direction for the specified GPIO line
+
+    The ParseLineDirection function sets the line direction for the
+    GPIO line object.  It is assumed the GPIO line handle has already
+    been assigned to the GPIO object.
+
+    Nine valid directions values are supported:  "input", "output",
+    "pwm", "counter", "frequency", "period", "pulse_width", "pulse"
+    and "pattern"
+
+    A "counter" is an input which counts its edges in a 64-bit counter.
+    The count is published at the publish interval of the line, or when
+    the variable is read.  The type of the variable is obtained from
+    the variable server, so the count can be published to a variable
+    of any integer or floating point type.
+
+    A "frequency" or "period" input measures the frequency of its edges
+    in Hz, or their period in microseconds, from the kernel event
+    timestamps.  The measurement is published at a fixed rate.
+
+    A "pulse_width" input measures the high time, low time and duty cycle
+    of its pulses from the kernel event timestamps.
+
+    A "pulse" output generates a timed pulse of the duration written to
+    its variable.
+
+    A "pattern" output repeats the output pattern selected by the index
+    written to its variable.
+
+    If the direction is not specified, it is assumed to be an "input"
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to store the line information in
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the "direction" attribute
+
+    @param[in]
+        pGPIOCtrlState
+            pointer to the GPIO controller state containing the handle to
+            the variable server to get the output value
+
+    @retval EOK the line information object was obtained
+    @retval ENOENT the line information was not found
+    @retval EINVAL invalid arguments or incorrect JSON format
+
+==============================================================================*/
+static int ParseLineDirection( GPIO *pGPIO,
+                               JNode *pNode,
+                               GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    char *direction;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pGPIO->pLine != NULL ) &&
+         ( pState != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* get the "direction" attribute from the GPIO line definition */
+        direction = JSON_GetStr( pNode, "direction" );
+        if ( direction == NULL )
+        {
+            direction = "input";
+        }
+
+        if ( strcmp( direction, "input" ) == 0 )
+        {
+            /* set the line to input */
+            pGPIO->direction = GPIOD_LINE_DIRECTION_INPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+            result = EOK;
+        }
+        else if( strcmp( direction, "output" ) == 0 )
+        {
+            /* set the line to "output" and set the default value */
+            pGPIO->direction = GPIOD_LINE_DIRECTION_OUTPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+            GetLineOutputValue( pState->hVarServer, pGPIO );
+            result = EOK;
+        }
+        else if( strcmp( direction, "pwm" ) == 0 )
+        {
+            /* set the line to "output" and set the default value */
+            pGPIO->PWM = true;
+            pGPIO->direction = GPIOD_LINE_DIRECTION_OUTPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+            GetLineOutputValue( pState->hVarServer, pGPIO );
+
+            /* get the PWM frequency and resolution */
+            result = ParseLinePWM( pGPIO, pNode );
+        }
+        else if ( strcmp( direction, "counter" ) == 0 )
+        {
+            /* set the line to an edge counting input */
+            pGPIO->inputMode = INPUT_MODE_COUNTER;
+            pGPIO->direction = GPIOD_LINE_DIRECTION_INPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+            pGPIO->varType = GetVarType( pState, pGPIO->hVar );
+            result = EOK;
+        }
+        else if ( ( strcmp( direction, "frequency" ) == 0 ) ||
+                  ( strcmp( direction, "period" ) == 0 ) )
+        {
+            /* set the line to a frequency measuring input */
+            pGPIO->inputMode = INPUT_MODE_FREQUENCY;
+            pGPIO->measurePeriod = ( strcmp( direction, "period" ) == 0 );
+            pGPIO->direction = GPIOD_LINE_DIRECTION_INPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+            pGPIO->varType = GetVarType( pState, pGPIO->hVar );
+            result = EOK;
+        }
+        else if ( strcmp( direction, "pulse" ) == 0 )
+        {
+            /* set the line to a pulse output, which starts inactive */
+            pGPIO->outputMode = OUTPUT_MODE_PULSE;
+            pGPIO->direction = GPIOD_LINE_DIRECTION_OUTPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+            pGPIO->value = 0;
+            result = EOK;
+        }
+        else if ( strcmp( direction, "pattern" ) == 0 )
+        {
+            /* set the line to a pattern output, which starts inactive */
+            pGPIO->outputMode = OUTPUT_MODE_PATTERN;
+            pGPIO->direction = GPIOD_LINE_DIRECTION_OUTPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+            pGPIO->value = 0;
+            TimerInit( &pGPIO->patternTimer, PatternTimer, pGPIO );
+            result = EOK;
+        }
+        else if ( strcmp( direction, "pulse_width" ) == 0 )
+        {
+            /* set the line to a pulse width measuring input */
+            pGPIO->inputMode = INPUT_MODE_PULSE_WIDTH;
+            pGPIO->direction = GPIOD_LINE_DIRECTION_INPUT;
+            pGPIO->request.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+            pGPIO->varType = GetVarType( pState, pGPIO->hVar );
+            result = EOK;
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLinePWM                                                              */
+/*!
+    Parse the GPIO definition to set the software PWM timing
+
+    The ParseLinePWM function sets the software PWM frequency and
+    resolution for the GPIO line object.
+
+    The frequency is specified in Hz using the "pwm_frequency" attribute.
+    If the frequency is not specified, the PWM period is 255 x 40us,
+    or approximately 98 Hz.
+
+    The resolution is specified in bits in the range [1..16] using the
+    "pwm_resolution" attribute.  The duty cycle is specified via the
+    value of the associated variable in the range [0..2^resolution - 1].
+    If the resolution is not specified, it is assumed to be 8 bits.
+
+    The PWM backend is specified using the "pwm_backend" attribute.
+    Three valid backends are supported: "software", "hardware" and "auto".
+    The hardware backend drives a sysfs pwmchip channel specified using
+    the "pwm_chip" and "pwm_channel" attributes.  The auto backend uses
+    the hardware PWM if it is available and falls back to the software
+    PWM otherwise.  If the backend is not specified, it is assumed to
+    be "software".
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object for the specified line
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the PWM attributes
+
+    @retval EOK the PWM timing was set up
+    @retval ENOTSUP the specified PWM timing was not supported
+    @retval ENOENT the hardware PWM channel was not specified
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLinePWM( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *frequency;
+    char *resolution;
+    char *backend;
+    char *chip;
+    char *channel;
+    double f;
+    int bits;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        /* set the default PWM timing */
+        pGPIO->pwmPeriod = PWM_DEFAULT_PERIOD_NS;
+        pGPIO->pwmResolution = PWM_DEFAULT_RESOLUTION;
+
+        /* get the "pwm_frequency" attribute from the GPIO line definition */
+        frequency = JSON_GetStr( pNode, "pwm_frequency" );
+        if ( frequency != NULL )
+        {
+            f = strtod( frequency, NULL );
+            if ( ( f > 0.0 ) && ( f <= (double)NS_PER_SEC ) )
+            {
+                pGPIO->pwmPeriod = (uint64_t)( (double)NS_PER_SEC / f );
+            }
+            else
+            {
+                /* unsupported PWM frequency */
+                result = ENOTSUP;
+            }
+        }
+
+        /* get the "pwm_resolution" attribute from the GPIO line definition */
+        resolution = JSON_GetStr( pNode, "pwm_resolution" );
+        if ( resolution != NULL )
+        {
+            bits = strtol( resolution, NULL, 0 );
+            if ( ( bits > 0 ) && ( bits <= PWM_MAX_RESOLUTION ) )
+            {
+                pGPIO->pwmResolution = bits;
+            }
+            else
+            {
+                /* unsupported PWM resolution */
+                result = ENOTSUP;
+            }
+        }
+
+        pGPIO->pwmMax = ( 1 << pGPIO->pwmResolution ) - 1;
+
+        /* get the "pwm_backend" attribute from the GPIO line definition */
+        pGPIO->pwmBackend = PWM_BACKEND_SOFTWARE;
+        pGPIO->pwmDutyFd = -1;
+        backend = JSON_GetStr( pNode, "pwm_backend" );
+        if ( backend != NULL )
+        {
+            if ( strcmp( backend, "hardware" ) == 0 )
+            {
+                pGPIO->pwmBackend = PWM_BACKEND_HARDWARE;
+            }
+            else if ( strcmp( backend, "auto" ) == 0 )
+            {
+                pGPIO->pwmBackend = PWM_BACKEND_AUTO;
+            }
+            else if ( strcmp( backend, "software" ) != 0 )
+            {
+                /* unsupported PWM backend */
+                result = ENOTSUP;
+            }
+        }
+
+        if ( pGPIO->pwmBackend != PWM_BACKEND_SOFTWARE )
+        {
+            /* get the hardware PWM chip and channel */
+            chip = JSON_GetStr( pNode, "pwm_chip" );
+            channel = JSON_GetStr( pNode, "pwm_channel" );
+            if ( ( chip != NULL ) && ( channel != NULL ) )
+            {
+                pGPIO->pwmChip = strtol( chip, NULL, 0 );
+                pGPIO->pwmChannel = strtol( channel, NULL, 0 );
+            }
+            else
+            {
+                /* the hardware PWM channel is not specified */
+                pGPIO->pwmBackend = PWM_BACKEND_SOFTWARE;
+                result = ENOENT;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineActiveState                                                      */
+/*!
+    Parse the GPIO definition to set the active state for the GPIO line
+
+    The ParseLineActiveState function sets the active state for the
+    GPIO line object.
+
+    Two valid active state values are supported:  "low" and "high"
+
+    If the active state is not specified, it is assumed to be "high"
+
+    If an active state is specified, the JSON object is expected to have an
+    attribute key "active_state"
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object for the specified line
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the "active_state" attribute
+
+    @retval EOK the line active state was set up
+    @retval ENOTSUP the specified line active state was not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineActiveState( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *active_state;
+    const char *consumer = "gpioctrl";
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        /* get the "active_state" attribute from the GPIO line definition */
+        active_state = JSON_GetStr( pNode, "active_state" );
+        if ( active_state != NULL )
+        {
+            if ( strcmp( active_state, "low" ) == 0 )
+            {
+                /* set the line to active low */
+                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW;
+            }
+            else if ( strcmp( active_state, "high" ) == 0 )
+            {
+                /* set the line to active low */
+                pGPIO->request.flags &= ~GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW;
+            }
+            else
+            {
+                /* unsupported line active state */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineEvent                                                            */
+/*!
+    Parse the GPIO definition to see if the GPIO input generates an event
+
+    The ParseLineEvent function checks the event attribute to determine
+    if the GPIO input triggers an event on transition.
+
+    Three valid event state values are supported: "RISING_EDGE",
+    "FALLING_EDGE" and "BOTH_EDGES"
+
+    If the event state is not specified, the line does not generate events,
+    except for counter and frequency inputs which use their rising edges.
+    A pulse width input always uses both edges, and a frequency or period
+    input configured for both edges uses its rising edges, as it needs
+    exactly one edge per period.
+
+    The "event_publish" attribute selects which events are written to the
+    line's variable.  Two valid values are supported: "final" and "all".
+    "final" writes only the final state after each batch of events is read,
+    and "all" writes every event.  If it is not specified, it is assumed
+    to be "final".
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object for the specified line
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the "event" attribute
+
+    @retval EOK the line event state was set up
+    @retval ENOTSUP the specified line event state was not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineEvent( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *event_state;
+    char *event_publish;
+    int event_type;
+    const char *consumer = "gpioctrl";
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        /* get the "active_state" attribute from the GPIO line definition */
+        event_state = JSON_GetStr( pNode, "event" );
+        if ( event_state != NULL )
+        {
+            if ( strcmp( event_state, "RISING_EDGE" ) == 0 )
+            {
+                /* event monitoring for rising edges */
+                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_RISING_EDGE;
+            }
+            else if ( strcmp( event_state, "FALLING_EDGE" ) == 0 )
+            {
+                /* event monitoring for falling edges */
+                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE;
+            }
+            else if ( strcmp( event_state, "BOTH_EDGES") == 0 )
+            {
+                /* event monitoring for both edges */
+                pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
+            }
+            else
+            {
+                /* unsupported line active state */
+                pGPIO->event_type = 0;
+                result = ENOTSUP;
+            }
+        }
+        else if ( pGPIO->inputMode != INPUT_MODE_LEVEL )
+        {
+            /* use rising edges by default */
+            pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_RISING_EDGE;
+        }
+        else
+        {
+            pGPIO->event_type = 0;
+        }
+
+        if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
+        {
+            /* pulse width measurement needs both edges */
+            pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
+        }
+        else if ( ( pGPIO->inputMode == INPUT_MODE_FREQUENCY ) &&
+                  ( pGPIO->event_type ==
+                        GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES ) )
+        {
+            /* frequency measurement needs one edge per period */
+            pGPIO->event_type = GPIOD_LINE_REQUEST_EVENT_RISING_EDGE;
+        }
+
+        /* get the "event_publish" attribute from the GPIO line definition */
+        event_publish = JSON_GetStr( pNode, "event_publish" );
+        if ( event_publish != NULL )
+        {
+            if ( strcmp( event_publish, "all" ) == 0 )
+            {
+                pGPIO->publishAll = true;
+            }
+            else if ( strcmp( event_publish, "final" ) == 0 )
+            {
+                pGPIO->publishAll = false;
+            }
+            else
+            {
+                /* unsupported event publishing mode */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLinePublish                                                          */
+/*!
+    Parse the GPIO definition to set the variable update rate limit
+
+    The ParseLinePublish function sets the minimum interval between
+    updates of the variable associated with the GPIO line.  The interval
+    can be specified with either of the following attributes:
+
+    "publish_interval_ms" : minimum interval between updates in milliseconds
+    "max_rate" : maximum number of updates per second
+
+    If neither attribute is specified, every update is published
+    immediately.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @retval EOK the GPIO publish interval was set
+    @retval ENOTSUP the specified publish interval is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLinePublish( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *interval;
+    char *rate;
+    double t;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        pGPIO->publishInterval = 0;
+        TimerInit( &pGPIO->publishTimer, PublishTimer, pGPIO );
+
+        /* get the "publish_interval_ms" attribute */
+        interval = JSON_GetStr( pNode, "publish_interval_ms" );
+        if ( interval != NULL )
+        {
+            t = strtod( interval, NULL );
+            if ( t >= 0.0 )
+            {
+                pGPIO->publishInterval = (uint64_t)( t * (double)NS_PER_MS );
+            }
+            else
+            {
+                /* unsupported publish interval */
+                result = ENOTSUP;
+            }
+        }
+
+        /* get the "max_rate" attribute */
+        rate = JSON_GetStr( pNode, "max_rate" );
+        if ( rate != NULL )
+        {
+            t = strtod( rate, NULL );
+            if ( t > 0.0 )
+            {
+                pGPIO->publishInterval = (uint64_t)( (double)NS_PER_SEC / t );
+            }
+            else
+            {
+                /* unsupported publish rate */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineDebounce                                                         */
+/*!
+    Parse the GPIO definition to set the debounce interval for the GPIO line
+
+    The ParseLineDebounce function sets the time an input level must be
+    stable before it is published, from the "debounce_us" attribute
+    which specifies the interval in microseconds.
+
+    If the debounce interval is not specified, the input is not debounced.
+    The debounce is applied by the kernel where the GPIO v2 uAPI is
+    available, otherwise it is applied by the userspace debounce filter.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @retval EOK the GPIO debounce interval was set
+    @retval ENOTSUP the specified debounce interval is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineDebounce( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *debounce;
+    long us;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        pGPIO->debounceInterval = 0;
+        pGPIO->kernelDebounce = false;
+        TimerInit( &pGPIO->debounceTimer, DebounceTimer, pGPIO );
+
+        /* get the "debounce_us" attribute from the GPIO line definition */
+        debounce = JSON_GetStr( pNode, "debounce_us" );
+        if ( debounce != NULL )
+        {
+            us = strtol( debounce, NULL, 0 );
+            if ( us >= 0 )
+            {
+                pGPIO->debounceInterval = (uint64_t)us * NS_PER_US;
+            }
+            else
+            {
+                /* unsupported debounce interval */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineMaxAge                                                           */
+/*!
+    Parse the GPIO definition to set the maximum age of a polled input
+
+    The ParseLineMaxAge function sets how long the level read from a
+    polled input may be returned from the cache, from the "max_age_us"
+    attribute which specifies the age in microseconds.
+
+    If the maximum age is not specified, the input is read every time its
+    variable is requested.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @retval EOK the maximum age was set
+    @retval ENOTSUP the specified maximum age is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineMaxAge( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *age;
+    long us;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        pGPIO->maxAge = 0;
+
+        /* get the "max_age_us" attribute from the GPIO line definition */
+        age = JSON_GetStr( pNode, "max_age_us" );
+        if ( age != NULL )
+        {
+            us = strtol( age, NULL, 0 );
+            if ( us >= 0 )
+            {
+                pGPIO->maxAge = (uint64_t)us * NS_PER_US;
+            }
+            else
+            {
+                /* unsupported maximum age */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineTimestamp                                                        */
+/*!
+    Parse the GPIO definition to set the event timestamp variable
+
+    The ParseLineTimestamp function gets the variable which receives
+    the kernel timestamp of the event which produced each published
+    value of an input line.  The following attributes are supported:
+
+    "timestamp_var" : name of a 64-bit variable which receives the
+                      event timestamp in nanoseconds
+    "timestamp_clock" : clock of the event timestamp.  One of
+                        "monotonic" or "realtime".  If not specified,
+                        it is assumed to be "monotonic".
+
+    If the timestamp variable is not specified, event timestamps are
+    not published.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state containing a handle
+            to the variable server
+
+    @retval EOK the GPIO event timestamp variable was set
+    @retval ENOENT the timestamp variable was not found
+    @retval ENOTSUP the timestamp clock is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineTimestamp( GPIO *pGPIO,
+                               JNode *pNode,
+                               GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    char *varname;
+    char *clock;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        pGPIO->hTimestampVar = VAR_INVALID;
+        pGPIO->timestampClock = CLOCK_MONOTONIC;
+
+        /* get the "timestamp_var" attribute from the GPIO line definition */
+        varname = JSON_GetStr( pNode, "timestamp_var" );
+        if ( varname != NULL )
+        {
+            pGPIO->hTimestampVar = VAR_FindByName( pState->hVarServer,
+                                                   varname );
+            if ( pGPIO->hTimestampVar == VAR_INVALID )
+            {
+                /* timestamp variable not found */
+                result = ENOENT;
+            }
+        }
+
+        /* get the "timestamp_clock" attribute */
+        clock = JSON_GetStr( pNode, "timestamp_clock" );
+        if ( clock != NULL )
+        {
+            if ( strcmp( clock, "realtime" ) == 0 )
+            {
+                pGPIO->timestampClock = CLOCK_REALTIME;
+            }
+            else if ( strcmp( clock, "monotonic" ) != 0 )
+            {
+                /* unsupported timestamp clock */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineFrequency                                                        */
+/*!
+    Parse the GPIO definition to set up a frequency measurement
+
+    The ParseLineFrequency function sets up the frequency measurement
+    of a frequency or period input, and starts publishing it at a fixed
+    rate.  The publish rate is specified with the "publish_interval_ms"
+    or "max_rate" attribute, and is once per second if not specified.
+    The following attributes are also supported:
+
+    "frequency_periods" : number of periods in each measurement.  If not
+                          specified, each measurement covers all of the
+                          periods in the publish interval.
+    "frequency_timeout_ms" : time without edges after which the frequency
+                             is 0 Hz.  If not specified, it is two publish
+                             intervals.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state containing the event
+            loop timers
+
+    @retval EOK the frequency measurement was set up
+    @retval ENOTSUP the measurement settings are not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineFrequency( GPIO *pGPIO,
+                               JNode *pNode,
+                               GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    char *periods;
+    char *timeout;
+    long n;
+    double t;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) &&
+         ( pState != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        if ( pGPIO->inputMode == INPUT_MODE_FREQUENCY )
+        {
+            if ( pGPIO->publishInterval == 0 )
+            {
+                pGPIO->publishInterval = FREQUENCY_DEFAULT_INTERVAL_NS;
+            }
+
+            pGPIO->freqTimeout = 2 * pGPIO->publishInterval;
+
+            /* get the "frequency_periods" attribute */
+            periods = JSON_GetStr( pNode, "frequency_periods" );
+            if ( periods != NULL )
+            {
+                n = strtol( periods, NULL, 0 );
+                if ( n > 0 )
+                {
+                    pGPIO->freqPeriods = n;
+                }
+                else
+                {
+                    /* unsupported number of periods */
+                    result = ENOTSUP;
+                }
+            }
+
+            /* get the "frequency_timeout_ms" attribute */
+            timeout = JSON_GetStr( pNode, "frequency_timeout_ms" );
+            if ( timeout != NULL )
+            {
+                t = strtod( timeout, NULL );
+                if ( t > 0.0 )
+                {
+                    pGPIO->freqTimeout = (uint64_t)( t * (double)NS_PER_MS );
+                }
+                else
+                {
+                    /* unsupported timeout */
+                    result = ENOTSUP;
+                }
+            }
+
+            /* publish the frequency at a fixed rate */
+            TimerInit( &pGPIO->freqTimer, FrequencyTimer, pGPIO );
+            if ( TimerStart( &pState->eventQueue,
+                             &pGPIO->freqTimer,
+                             GetMonotonicTime() +
+                                pGPIO->publishInterval ) != EOK )
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLinePulse                                                            */
+/*!
+    Parse the GPIO definition to set up a pulse width measurement
+
+    The ParseLinePulse function sets up the pulse width measurement of a
+    pulse width input.  The following attributes are supported:
+
+    "pulse_measure" : measurement published to the variable.  One of
+                      "duty" ( duty cycle in percent ), "high" ( high time
+                      in microseconds ) or "low" ( low time in
+                      microseconds ).  If not specified, it is "duty".
+    "pulse_cycles" : number of cycles averaged in each measurement.
+                     If not specified, each cycle is a measurement.
+
+    Measurements are published at most once per publish interval, which
+    is 100ms if the "publish_interval_ms" or "max_rate" attribute is not
+    specified.
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @retval EOK the pulse width measurement was set up
+    @retval ENOTSUP the measurement settings are not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLinePulse( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *measure;
+    char *cycles;
+    long n;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
+        {
+            if ( pGPIO->publishInterval == 0 )
+            {
+                pGPIO->publishInterval = PULSE_DEFAULT_INTERVAL_NS;
+            }
+
+            /* get the "pulse_measure" attribute */
+            pGPIO->pulseMeasure = PULSE_MEASURE_DUTY;
+            measure = JSON_GetStr( pNode, "pulse_measure" );
+            if ( measure != NULL )
+            {
+                if ( strcmp( measure, "high" ) == 0 )
+                {
+                    pGPIO->pulseMeasure = PULSE_MEASURE_HIGH;
+                }
+                else if ( strcmp( measure, "low" ) == 0 )
+                {
+                    pGPIO->pulseMeasure = PULSE_MEASURE_LOW;
+                }
+                else if ( strcmp( measure, "duty" ) != 0 )
+                {
+                    /* unsupported pulse width measurement */
+                    result = ENOTSUP;
+                }
+            }
+
+            /* get the "pulse_cycles" attribute */
+            pGPIO->pulseCycles = 1;
+            cycles = JSON_GetStr( pNode, "pulse_cycles" );
+            if ( cycles != NULL )
+            {
+                n = strtol( cycles, NULL, 0 );
+                if ( n > 0 )
+                {
+                    pGPIO->pulseCycles = n;
+                }
+                else
+                {
+                    /* unsupported number of cycles */
+                    result = ENOTSUP;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineOneShot                                                          */
+/*!
+    Parse the GPIO definition to set up a pulse output
+
+    The ParseLineOneShot function sets up the timing of a pulse output.
+    The following attributes are supported:
+
+    "pulse_units" : units of the pulse duration written to the variable.
+                    One of "us" or "ms".  If not specified, it is "ms".
+    "pulse_retrigger" : action when the variable is written during a
+                        pulse.  One of "restart" ( the pulse ends the new
+                        duration after the write ) or "extend" ( the new
+                        duration is added to the end of the pulse ).
+                        If not specified, it is "restart".
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @retval EOK the pulse output was set up
+    @retval ENOTSUP the pulse output settings are not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineOneShot( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *units;
+    char *retrigger;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        if ( pGPIO->outputMode == OUTPUT_MODE_PULSE )
+        {
+            TimerInit( &pGPIO->oneShotTimer, OneShotTimer, pGPIO );
+
+            /* get the "pulse_units" attribute */
+            pGPIO->oneShotUnit = NS_PER_MS;
+            units = JSON_GetStr( pNode, "pulse_units" );
+            if ( units != NULL )
+            {
+                if ( strcmp( units, "us" ) == 0 )
+                {
+                    pGPIO->oneShotUnit = NS_PER_US;
+                }
+                else if ( strcmp( units, "ms" ) != 0 )
+                {
+                    /* unsupported pulse units */
+                    result = ENOTSUP;
+                }
+            }
+
+            /* get the "pulse_retrigger" attribute */
+            pGPIO->oneShotExtend = false;
+            retrigger = JSON_GetStr( pNode, "pulse_retrigger" );
+            if ( retrigger != NULL )
+            {
+                if ( strcmp( retrigger, "extend" ) == 0 )
+                {
+                    pGPIO->oneShotExtend = true;
+                }
+                else if ( strcmp( retrigger, "restart" ) != 0 )
+                {
+                    /* unsupported retrigger action */
+                    result = ENOTSUP;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineBias                                                             */
+/*!
+    Parse the GPIO definition to set the bias for the GPIO line
+
+    The ParseLineBias function sets the bias for the
+    GPIO line object.
+
+    Three valid bias state values are supported:
+        "disabled", "pull-down", "pull-up"
+
+    If the bias is not specified, it is assumed to be "disabled"
+
+    If a bias is specified, the JSON object is expected to have an
+    attribute key "bias"
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object for the specified line
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the "bias" attribute
+
+    @retval EOK the line bias was set up
+    @retval ENOTSUP the specified line bias was not supported
+    @retval EINVAL invalid arguments or incorrect JSON format
+
+==============================================================================*/
+static int ParseLineBias( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *bias;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        /* get the "bias" attribute from the GPIO line definition */
+        bias = JSON_GetStr( pNode, "bias" );
+        if ( bias != NULL )
+        {
+            if ( strcmp( bias, "disabled" ) == 0 )
+            {
+                /* set the bias to disabled */
+                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_BIAS_DISABLE;
+            }
+            else if ( strcmp( bias, "pull-down" ) == 0 )
+            {
+                /* set the bias to pull-down */
+                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_DOWN;
+            }
+            else if ( strcmp( bias, "pull-up" ) == 0 )
+            {
+                /* set the bias to pull-up */
+                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP;
+            }
+            else
+            {
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineDrive                                                            */
+/*!
+    Parse the GPIO definition to set the drive mode for the GPIO line
+
+    The ParseLineDrive function sets the drive mode for the GPIO line object.
+
+    Three valid drive mode values are supported:
+        "push-pull", "open-drain", "open-source"
+
+    If the drive mode is not specified, it is assumed to be "push-pull"
+
+    If a drive mode is specified, the JSON object is expected to have an
+    attribute key "drive"
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object for the specified line
+
+    @param[in]
+        pNode
+            pointer to the line node to search for the "drive" attribute
+
+    @retval EOK the line bias was set up
+    @retval ENOTSUP the specified line bias was not supported
+    @retval EINVAL invalid arguments or incorrect JSON format
+
+==============================================================================*/
+static int ParseLineDrive( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *drive;
+    int pushpull = ~( GPIOD_LINE_REQUEST_FLAG_OPEN_DRAIN |
+                      GPIOD_LINE_REQUEST_FLAG_OPEN_SOURCE );
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        /* get the "drive" attribute from the GPIO line definition */
+        drive = JSON_GetStr( pNode, "drive" );
+        if ( drive != NULL )
+        {
+            if ( strcmp( drive, "push-pull" ) == 0 )
+            {
+                /* set the drive to push-pull by clearing the open-source
+                 * and open-drain bits */
+                pGPIO->request.flags &= pushpull;
+            }
+            else if ( strcmp( drive, "open-source" ) == 0 )
+            {
+                /* set the drive mode to open-source */
+                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_OPEN_SOURCE;
+            }
+            else if ( strcmp( drive, "open-drain" ) == 0 )
+            {
+                /* set the drive mode to open-drain */
+                pGPIO->request.flags |= GPIOD_LINE_REQUEST_FLAG_OPEN_DRAIN;
+            }
+            else
+            {
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseLineForceWrite                                                       */
+/*!
+    Parse the GPIO definition to set the output write mode
+
+    The ParseLineForceWrite function checks the "force_write" attribute
+    to determine if every update of an output is written to the hardware.
+    By default, an update which does not change the output is skipped.
+
+    Two valid values are supported: "true" and "false"
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to update
+
+    @param[in]
+        pNode
+            pointer to the JSON GPIO line definition object
+
+    @retval EOK the GPIO output write mode was set
+    @retval ENOTSUP the specified write mode is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseLineForceWrite( GPIO *pGPIO, JNode *pNode )
+{
+    int result = EINVAL;
+    char *force_write;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pNode != NULL ) )
+    {
+        /* indicate success */
+        result = EOK;
+
+        pGPIO->forceWrite = false;
+
+        /* get the "force_write" attribute from the GPIO line definition */
+        force_write = JSON_GetStr( pNode, "force_write" );
+        if ( force_write != NULL )
+        {
+            if ( strcmp( force_write, "true" ) == 0 )
+            {
+                pGPIO->forceWrite = true;
+            }
+            else if ( strcmp( force_write, "false" ) != 0 )
+            {
+                /* unsupported write mode */
+                result = ENOTSUP;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetLineOutputValue                                                        */
+/*!
+    Get the value from the variable associated with the GPIO output line
+
+    The GetLineOutputValue function gets the value from the variable associated
+    with the specified GPIO line but only if the line direction is "output".
+
+    The type of the variable must be VARTYPE_UINT16
+
+    The line direction must be "output"
+
+    @param[in]
+        hVarServer
+            handle to the variable server to query the variable value
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object to store the variable value
+
+    @retval EOK the variable value was successfully retrieved
+    @retval ENOENT the variable was not found
+    @retval ENOTSUP invalid variable type or incorrect direction
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int GetLineOutputValue( VARSERVER_HANDLE hVarServer, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    VarObject var;
+    int direction;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( pGPIO->hVar != VAR_INVALID ) &&
+         ( pGPIO->pLine != NULL ) )
+    {
+        /* get the line direction */
+        direction = pGPIO->direction;
+        if ( direction == GPIOD_LINE_DIRECTION_OUTPUT )
+        {
+            /* get the variable value */
+            if ( VAR_Get( hVarServer, pGPIO->hVar, &var ) == EOK )
+            {
+                if( var.type == VARTYPE_UINT16 )
+                {
+                    /* get the requested GPIO output value and store it
+                     * in the GPIO object */
+                    pGPIO->value = var.val.ui;
+
+                    /* indicate success */
+                    result = EOK;
+                }
+                else
+                {
+                    result = ENOTSUP;
+                }
+            }
+            else
+            {
+                /* cannot get variable */
+                result = ENOENT;
+            }
+        }
+        else
+        {
+            /* unsupported operation */
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BuildGPIOTable                                                            */
+/*!
+    Build the variable handle to GPIO line dispatch table
+
+    The BuildGPIOTable function is called once after all of the GPIO chips
+    have been parsed.  It allocates a table which is directly indexed by
+    variable handle, and populates it with a pointer to the GPIO line
+    associated with each variable.  Variable handles allocated by the
+    variable server are small dense integers, so the table stays compact,
+    and lookups in FindGPIO take constant time regardless of the number
+    of chips and lines being managed.
+
+    @param[in]
+        pState
+            pointer to the GPIOCtrl state which contains the list of
+            GPIO chips to index
+
+    @retval EOK the dispatch table was built
+    @retval ENOENT there are no GPIO lines to index
+    @retval ENOMEM the dispatch table could not be allocated
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int BuildGPIOTable( GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    GPIOChip *pGPIOChip;
+    GPIO *pGPIO;
+    VAR_HANDLE hMax = VAR_INVALID;
+
+    if ( pState != NULL )
+    {
+        /* find the largest variable handle in use */
+        pGPIOChip = pState->pFirstGPIOChip;
+        while ( pGPIOChip != NULL )
+        {
+            pGPIO = pGPIOChip->pFirstLine;
+            while ( pGPIO != NULL )
+            {
+                if ( pGPIO->hVar > hMax )
+                {
+                    hMax = pGPIO->hVar;
+                }
+
+                pGPIO = pGPIO->pNext;
+            }
+
+            pGPIOChip = pGPIOChip->pNext;
+        }
+
+        if ( hMax != VAR_INVALID )
+        {
+            /* allocate the dispatch table */
+            pState->pGPIOTable = calloc( (size_t)hMax + 1, sizeof( GPIO * ) );
+            if ( pState->pGPIOTable != NULL )
+            {
+                pState->nGPIOTable = (size_t)hMax + 1;
+
+                /* populate the dispatch table */
+                pGPIOChip = pState->pFirstGPIOChip;
+                while ( pGPIOChip != NULL )
+                {
+                    pGPIO = pGPIOChip->pFirstLine;
+                    while ( pGPIO != NULL )
+                    {
+                        /* the first mapping for a variable takes precedence,
+                         * to match the behavior of the list search */
+                        if ( pState->pGPIOTable[pGPIO->hVar] == NULL )
+                        {
+                            pState->pGPIOTable[pGPIO->hVar] = pGPIO;
+                        }
+
+                        pGPIO = pGPIO->pNext;
+                    }
+
+                    pGPIOChip = pGPIOChip->pNext;
+                }
+
+                result = EOK;
+            }
+            else
+            {
+                /* fall back to searching the GPIO lists */
+                syslog( LOG_ERR, "unable to allocate GPIO dispatch table" );
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FindGPIO                                                                  */
+/*!
+    Find a GPIO given a handle to its associated variable
+
+    The FindGPIO function looks up the GPIO line associated with the
+    specified variable handle in the dispatch table built by BuildGPIOTable.
+    If the dispatch table is not available, it falls back to searching
+    the GPIO chip lists.
+
+    @param[in]
+        pState
+            pointer to the GPIOCtrl state which contains the dispatch table
+
+    @param[in]
+        hVar
+            handle of the variable to search for
+
+    @retval pointer to the GPIO line object associated with the specified var
+    @retval NULL if the GPIO line object could not be found
+
+==============================================================================*/
+static GPIO *FindGPIO( GPIOCtrlState *pState, VAR_HANDLE hVar )
+{
+    GPIO *foundGPIO = NULL;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        if ( pState->pGPIOTable != NULL )
+        {
+            if ( (size_t)hVar < pState->nGPIOTable )
+            {
+                foundGPIO = pState->pGPIOTable[hVar];
+            }
+        }
+        else
+        {
+            foundGPIO = SearchGPIO( pState, hVar );
+        }
+    }
+
+    /* return the found GPIO, or NULL if it is not found */
+    return foundGPIO;
+}
+
+/*============================================================================*/
+/*  SearchGPIO                                                                */
+/*!
+    Search for a GPIO given a handle to its associated variable
+
+    The SearchGPIO function iterates through all of the GPIO chips looking
+    for the GPIO line associated with the specified variable handle.
+    It is used only when the dispatch table is not available.
+
+    @param[in]
+        pState
+            pointer to the GPIOCtrl state which contains the list of
+            GPIO chips to search
+
+    @param[in]
+        hVar
+            handle of the variable to search for
+
+    @retval pointer to the GPIO line object associated with the specified var
+    @retval NULL if the GPIO line object could not be found
+
+==============================================================================*/
+static GPIO *SearchGPIO( GPIOCtrlState *pState, VAR_HANDLE hVar )
+{
+    GPIOChip *pGPIOChip;
+    GPIO *pGPIO;
+    GPIO *foundGPIO = NULL;
+    bool found = false;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        /* start looking in the first GPIO chip */
+        pGPIOChip = pState->pFirstGPIOChip;
+        while ( ( pGPIOChip != NULL ) && ( found == false ) )
+        {
+            /* start looking in the first line of the chip */
+            pGPIO = pGPIOChip->pFirstLine;
+            while( ( pGPIO != NULL ) && ( found == false ) )
+            {
+                /* check for a variable handle match */
+                if( pGPIO->hVar == hVar )
+                {
+                    /* save the found GPIO line */
+                    foundGPIO = pGPIO;
+
+                    /* abort the search */
+                    found = true;
+                }
+
+                /* move on to the next GPIO line */
+                pGPIO = pGPIO->pNext;
+            }
+
+            /* move to the next GPIO chip */
+            pGPIOChip = pGPIOChip->pNext;
+        }
+    }
+
+    /* return the found GPIO, or NULL if it is not found */
+    return foundGPIO;
+}
+
+/*============================================================================*/
+/*  AddEventIndex                                                             */
+/*!
+    Add a monitored GPIO line to the event reverse index
+
+    The AddEventIndex function adds the specified GPIO line to the
+    reverse index used by the event loop to map a ready line event file
+    descriptor back to its GPIO object.  The index is directly indexed by
+    the line's event file descriptor, which is a small integer unique to
+    each requested line.
+    The index is grown as required while the lines are being requested
+    at startup.  The event history ring of the line is allocated here, so
+    that lines which never generate events do not carry one.  If the ring
+    cannot be allocated, the line is still indexed but has no history.
+
+    @param[in]
+        pState
+            pointer to the GPIOCtrl state which contains the reverse index
+
+    @param[in]
+        pGPIO
+            pointer to the GPIO object of a line requested for events
+
+    @retval EOK the GPIO line was added to the reverse index
+    @retval EBADF the line does not have an event file descriptor
+    @retval ENOMEM the reverse index could not be grown
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddEventIndex( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    GPIO **pTable;
+    size_t n;
+    int fd;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( pGPIO->pLine != NULL ) )
+    {
+        fd = ( pGPIO->lineFd != -1 ) ? pGPIO->lineFd
+                                     : gpiod_line_event_get_fd( pGPIO->pLine );
+        if ( fd >= 0 )
+        {
+            /* the event queue is drained until it is empty, so reads
+             * must not block */
+            fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+
+            n = pState->nEventTable;
+            if ( (size_t)fd >= n )
+            {
+                /* grow the reverse index to hold the new descriptor */
+                pTable = realloc( pState->pEventTable,
+                                  ( (size_t)fd + 1 ) * sizeof( GPIO * ) );
+                if ( pTable != NULL )
+                {
+                    memset( &pTable[n], 0, ( fd + 1 - n ) * sizeof( GPIO * ) );
+                    pState->pEventTable = pTable;
+                    pState->nEventTable = (size_t)fd + 1;
+                }
+            }
+
+            if ( (size_t)fd < pState->nEventTable )
+            {
+                pState->pEventTable[fd] = pGPIO;
+
+                if ( pGPIO->pHistory == NULL )
+                {
+                    pGPIO->pHistory = calloc( HISTORY_SIZE,
+                                              sizeof( HistoryEntry ) );
+                }
+
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = EBADF;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FindEventGPIO                                                             */
+/*!
+    Find a GPIO given its line event file descriptor
+
+    The FindEventGPIO function looks up the GPIO object associated with
+    the specified line event file descriptor using the event reverse index.
+
+    @param[in]
+        pState
+            pointer to the GPIOCtrl state which contains the reverse index
+
+    @param[in]
+        fd
+            line event file descriptor to search for
+
+    @retval pointer to the GPIO object associated with the file descriptor
+    @retval NULL if the GPIO object could not be found
+
+==============================================================================*/
+static GPIO *FindEventGPIO( GPIOCtrlState *pState, int fd )
+{
+    GPIO *pGPIO = NULL;
+
+    if ( ( pState != NULL ) &&
+         ( fd >= 0 ) &&
+         ( (size_t)fd < pState->nEventTable ) )
+    {
+        pGPIO = pState->pEventTable[fd];
+    }
+
+    return pGPIO;
+}
+
+/*==========================================================================*/
+/*  usage                                                                   */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message
+    to stderr.
+
+    @param[in]
+       cmdname
+            pointer to the invoked command name
+
+    @return none
+
+============================================================================*/
+static void usage( char *cmdname )
+{
+    if( cmdname != NULL )
+    {
+        fprintf(stderr,
+                "usage: %s [-v] [-h] [-p <path>] "
+                " [-h] : display this help"
+                " [-v] : verbose output"
+                " [-p <path>] : hardware PWM sysfs location"
+                " -f <filename> : configuration file",
+                cmdname );
+    }
+}
+
+/*==========================================================================*/
+/*  ProcessOptions                                                          */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the GPIOCtrlState object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pState
+            pointer to the GPIOCtrl state object
+
+    @return none
+
+============================================================================*/
+static int ProcessOptions( int argC, char *argV[], GPIOCtrlState *pState )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "hvf:p:";
+
+    if( ( pState != NULL ) &&
+        ( argV != NULL ) )
+    {
+        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'v':
+                    pState->verbose = true;
+                    break;
+
+                case 'h':
+                    usage( argV[0] );
+                    break;
+
+                case 'f':
+                    pState->pFileName = strdup(optarg);
+                    break;
+
+                case 'p':
+                    pState->pPWMSysfs = strdup(optarg);
+                    break;
+
+                default:
+                    break;
+
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*============================================================================*/
+/*  SetupTerminationHandler                                                   */
+/*!
+    Set up an abnormal termination handler
+
+    The SetupTerminationHandler function registers a termination handler
+    function with the kernel in case of an abnormal termination of this
+    process.
+
+==============================================================================*/
+static void SetupTerminationHandler( void )
+{
+    static struct sigaction sigact;
+
+    memset( &sigact, 0, sizeof(sigact) );
+
+    sigact.sa_sigaction = TerminationHandler;
+    sigact.sa_flags = SA_SIGINFO;
+
+    sigaction( SIGTERM, &sigact, NULL );
+    sigaction( SIGINT, &sigact, NULL );
+
+}
+
+/*============================================================================*/
+/*  TerminationHandler                                                        */
+/*!
+    Abnormal termination handler
+
+    The TerminationHandler function will be invoked in case of an abnormal
+    termination of this process.  The termination handler closes
+    the connection with the variable server and cleans up its VARFP shared
+    memory.
+
+@param[in]
+    signum
+        The signal which caused the abnormal termination (unused)
+
+@param[in]
+    info
+        pointer to a siginfo_t object (unused)
+
+@param[in]
+    ptr
+        signal context information (ucontext_t) (unused)
+
+==============================================================================*/
+static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
+{
+    syslog( LOG_ERR, "termination of gpioctrl\n" );
+    state.running = false;
+}
+
+/*============================================================================*/
+/*  UpdateOutput                                                              */
+/*!
+    Update a GPIO output
+
+    The UpdateOutput function will be find the variable given by it's handle,
+    get the variable value, and write either a 1 (variable value is non-zero),
+    or a 0 (variable value is zero) to the GPIO line associated with the
+    variable handle.  If the variable is associated with a line group,
+    the variable value is written to all of the lines of the group.
+
+    Writing to the variable of a pulse output starts a pulse.
+
+    The last value written to each output is kept as a shadow of the
+    output state, and an update which does not change the output is not
+    written to the hardware, unless the output is configured to force
+    every write.
+
+@param[in]
+    hVar
+        Handle for the variable associated with the GPIO output
+
+@param[in]
+    pState
+        pointer to a GPIOCtrlState object which contains the GPIO lines,
+        and a handle to the variable server
+
+@retval EOK the GPIO line was updated correctly
+@retval ENOENT the variable was not found
+@retval ENOTSUP the variable type was invalid, or the GPIO is not an output
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int UpdateOutput( VAR_HANDLE hVar, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    GPIO *pGPIO;
+    VarObject var;
+    int direction;
+    int value;
+    int rc;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        /* find the GPIO associated with the specified variable */
+        pGPIO = FindGPIO( pState, hVar );
+        if ( ( pGPIO != NULL ) &&
+             ( pGPIO->pGroup != NULL ) )
+        {
+            /* write the group value */
+            result = UpdateGroupOutput( pState, pGPIO->pGroup );
+        }
+        else if ( ( pGPIO != NULL ) &&
+                  ( pGPIO->outputMode == OUTPUT_MODE_PULSE ) )
+        {
+            /* start the pulse */
+            result = StartOneShot( pState, pGPIO );
+        }
+        else if ( ( pGPIO != NULL ) &&
+                  ( pGPIO->outputMode == OUTPUT_MODE_PATTERN ) )
+        {
+            /* select the output pattern */
+            result = StartPattern( pState, pGPIO );
+        }
+        else if( pGPIO != NULL )
+        {
+            /* get the direction of this GPIO */
+            direction = pGPIO->direction;
+
+            /* confirm it is an output */
+            if ( direction == GPIOD_LINE_DIRECTION_OUTPUT )
+            {
+                /* get the requested output value */
+                if ( VAR_Get( pState->hVarServer,
+                              hVar,
+                              &var ) == EOK )
+                {
+                    if ( var.type == VARTYPE_UINT16 )
+                    {
+                        if( pGPIO->PWM == true )
+                        {
+                            pGPIO->value = ( var.val.ui <= pGPIO->pwmMax )
+                                            ? var.val.ui
+                                            : pGPIO->pwmMax;
+
+                            /* hand the new value to the PWM scheduler
+                             * thread */
+                            atomic_store_explicit( &pGPIO->pwmValue,
+                                                   pGPIO->value,
+                                                   memory_order_relaxed );
+
+                            if ( pGPIO->pwmHardware == true )
+                            {
+                                /* set the hardware PWM duty cycle */
+                                result = SetHardwarePWM( pGPIO );
+                                if ( result != EOK )
+                                {
+                                    syslog( LOG_ERR, "UpdateOutput: %d %s",
+                                            result,
+                                            strerror(result) );
+                                }
+                            }
+
+                            result = EOK;
+                        }
+                        else
+                        {
+                            /* get the value to write to the output */
+                            value = ( var.val.ui > 0 ) ? 1 : 0;
+
+                            if ( ( value == pGPIO->value ) &&
+                                 ( pGPIO->forceWrite == false ) )
+                            {
+                                /* the output is already at this value */
+                                pState->stats.writesSuppressed++;
+                                rc = EOK;
+                            }
+                            else
+                            {
+                                /* set the output value to the hardware */
+                                pState->stats.writesIssued++;
+                                rc = gpiod_line_set_value( pGPIO->pLine,
+                                                           value );
+                            }
+
+                            /* check the result */
+                            result = ( rc == EOK ) ? EOK : errno;
+                            if( result != EOK )
+                            {
+                                syslog( LOG_ERR, "UpdateOutput: %d %s",
+                                        result,
+                                        strerror(result) );
+                            }
+                            else
+                            {
+                                /* update the output shadow */
+                                pGPIO->value = value;
+                            }
+                            result = EOK;
+                        }
+                    }
+                    else
+                    {
+                        /* invalid data type */
+                        result = ENOTSUP;
+                    }
+                }
+                else
+                {
+                    /* unable to get the value */
+                    result = ENOENT;
+                }
+            }
+            else
+            {
+                /* invalid line direction */
+                result = ENOTSUP;
+            }
+        }
+        else
+        {
+            /* variable not found */
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdateGroupOutput                                                         */
+/*!
+    Update an output line group
+
+    The UpdateGroupOutput function gets the value of the line group
+    variable, and writes it to all of the lines of the group.  The write
+    is skipped if the group is already at the requested value, unless
+    the group is configured to force every write.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGroup
+        pointer to the line group to update
+
+@retval EOK the line group was updated
+@retval ENOTSUP the group is not an output, or the variable type is invalid
+@retval EINVAL invalid arguments
+@retval other error writing the line group
+
+==============================================================================*/
+static int UpdateGroupOutput( GPIOCtrlState *pState, LineGroup *pGroup )
+{
+    int result = EINVAL;
+    uint64_t value;
+
+    if ( ( pState != NULL ) &&
+         ( pGroup != NULL ) &&
+         ( pGroup->nLines > 0 ) )
+    {
+        if ( pGroup->direction == GPIOD_LINE_DIRECTION_OUTPUT )
+        {
+            result = GetVarInteger( pState, pGroup->hVar, &value );
+            if ( ( result == EOK ) &&
+                 ( value == pGroup->value ) &&
+                 ( pGroup->stale == false ) &&
+                 ( pGroup->pLines[0]->forceWrite == false ) )
+            {
+                /* the group is already at this value */
+                pState->stats.writesSuppressed++;
+            }
+            else if ( result == EOK )
+            {
+                pState->stats.writesIssued++;
+                pGroup->value = value;
+                result = WriteGroup( pGroup );
+
+                /* make sure the next update is written if the shadow
+                 * may no longer match the hardware */
+                pGroup->stale = ( result != EOK );
+                if ( result != EOK )
+                {
+                    syslog( LOG_ERR, "UpdateGroupOutput: %d %s",
+                            result,
+                            strerror(result) );
+                }
+            }
+        }
+        else
+        {
+            /* unsupported action on this line group */
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StartOneShot                                                              */
+/*!
+    Start a pulse output
+
+    The StartOneShot function gets the pulse duration from the variable
+    of a pulse output, activates the output, and schedules the end of
+    the pulse on the event loop timer queue at an absolute time, so the
+    pulse width does not depend on the client.  If the output is already
+    active, the pulse is restarted, or extended by the new duration.
+    A duration of 0 ends the pulse immediately.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGPIO
+        pointer to the pulse output
+
+@retval EOK the pulse was started
+@retval ENOTSUP the variable type is invalid
+@retval EINVAL invalid arguments
+@retval other error writing the output or starting the timer
+
+==============================================================================*/
+static int StartOneShot( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    uint64_t duration;
+    uint64_t now;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        result = GetVarInteger( pState, pGPIO->hVar, &duration );
+        if ( result == EOK )
+        {
+            now = GetMonotonicTime();
+            duration *= pGPIO->oneShotUnit;
+
+            if ( duration == 0 )
+            {
+                /* cancel the pulse */
+                pGPIO->oneShotEnd = now;
+            }
+            else if ( ( pGPIO->oneShotExtend == true ) &&
+                      ( pGPIO->oneShotTimer.index >= 0 ) )
+            {
+                /* extend the active pulse */
+                pGPIO->oneShotEnd += duration;
+            }
+            else
+            {
+                /* (re)start the pulse */
+                pGPIO->oneShotEnd = now + duration;
+            }
+
+            if ( pGPIO->oneShotEnd <= now )
+            {
+                /* end the pulse now */
+                TimerStop( &pState->eventQueue, &pGPIO->oneShotTimer );
+                OneShotTimer( &pState->eventQueue, &pGPIO->oneShotTimer, now );
+            }
+            else
+            {
+                if ( pGPIO->value == 0 )
+                {
+                    /* activate the output */
+                    pState->stats.writesIssued++;
+                    if ( gpiod_line_set_value( pGPIO->pLine, 1 ) == 0 )
+                    {
+                        pGPIO->value = 1;
+                    }
+                    else
+                    {
+                        result = errno;
+                    }
+                }
+
+                if ( result == EOK )
+                {
+                    /* schedule the end of the pulse */
+                    result = TimerStart( &pState->eventQueue,
+                                         &pGPIO->oneShotTimer,
+                                         pGPIO->oneShotEnd );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  OneShotTimer                                                              */
+/*!
+    End a pulse output
+
+    The OneShotTimer function is the event loop timer handler which
+    deactivates a pulse output at the end of its pulse.  If the end of
+    the pulse is still in the future, the timer is restarted for it
+    instead.
+
+    @param[in]
+        pQueue
+            pointer to the event loop timer queue
+
+    @param[in]
+        pTimer
+            pointer to the pulse timer which expired
+
+    @param[in]
+        now
+            current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static void OneShotTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now )
+{
+    GPIOCtrlState *pState;
+    GPIO *pGPIO;
+
+    if ( ( pQueue != NULL ) && ( pTimer != NULL ) )
+    {
+        pState = (GPIOCtrlState *)pQueue->arg;
+        pGPIO = (GPIO *)pTimer->arg;
+        if ( ( pState != NULL ) && ( pGPIO != NULL ) )
+        {
+            if ( now < pGPIO->oneShotEnd )
+            {
+                /* the pulse has not ended yet */
+                TimerStart( pQueue, pTimer, pGPIO->oneShotEnd );
+            }
+            else if ( pGPIO->value != 0 )
+            {
+                /* deactivate the output */
+                pState->stats.writesIssued++;
+                if ( gpiod_line_set_value( pGPIO->pLine, 0 ) == 0 )
+                {
+                    pGPIO->value = 0;
+                }
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  StartPattern                                                              */
+/*!
+    Select the pattern of a pattern output
+
+    The StartPattern function gets the pattern index from the variable
+    of a pattern output, and starts the selected pattern from its first
+    step.  The pattern steps are run by the event loop timer queue, so
+    no further variable server requests are needed until a different
+    pattern is selected.  Selecting the pattern which is already running
+    does not restart it.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGPIO
+        pointer to the pattern output
+
+@retval EOK the pattern was started
+@retval ENOTSUP the variable type or pattern index is invalid
+@retval EINVAL invalid arguments
+@retval other error writing the output or starting the timer
+
+==============================================================================*/
+static int StartPattern( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    const OutputPattern *pPattern;
+    uint64_t index;
+    int level;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        result = GetVarInteger( pState, pGPIO->hVar, &index );
+        if ( ( result == EOK ) &&
+             ( index >= sizeof( patterns ) / sizeof( patterns[0] ) ) )
+        {
+            result = ENOTSUP;
+        }
+        else if ( ( result == EOK ) &&
+                  ( pGPIO->pPattern != &patterns[index] ) )
+        {
+            pPattern = &patterns[index];
+            pGPIO->pPattern = pPattern;
+            pGPIO->patternStep = 0;
+
+            TimerStop( &pState->eventQueue, &pGPIO->patternTimer );
+
+            /* a pattern starts with an active step */
+            level = ( pPattern->nSteps > 0 ) ? 1 : pPattern->level;
+            if ( pGPIO->value != level )
+            {
+                pState->stats.writesIssued++;
+                if ( gpiod_line_set_value( pGPIO->pLine, level ) == 0 )
+                {
+                    pGPIO->value = level;
+                }
+                else
+                {
+                    result = errno;
+                }
+            }
+
+            if ( ( result == EOK ) &&
+                 ( pPattern->nSteps > 0 ) )
+            {
+                /* schedule the end of the first step */
+                result = TimerStart( &pState->eventQueue,
+                                     &pGPIO->patternTimer,
+                                     GetMonotonicTime() +
+                                        pPattern->steps[0] * NS_PER_MS );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PatternTimer                                                              */
+/*!
+    Step a pattern output
+
+    The PatternTimer function is the event loop timer handler which
+    moves a pattern output to the next step of its pattern.  Each step
+    is scheduled from the due time of the previous step rather than the
+    current time, so the pattern does not drift.  If the event loop
+    stalls past the end of a step, the pattern continues from the
+    current time.
+
+    @param[in]
+        pQueue
+            pointer to the event loop timer queue
+
+    @param[in]
+        pTimer
+            pointer to the pattern timer which expired
+
+    @param[in]
+        now
+            current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static void PatternTimer( TimerQueue *pQueue, Timer *pTimer, uint64_t now )
+{
+    GPIOCtrlState *pState;
+    GPIO *pGPIO;
+    const OutputPattern *pPattern;
+    uint64_t due;
+    int level;
+
+    if ( ( pQueue != NULL ) && ( pTimer != NULL ) )
+    {
+        pState = (GPIOCtrlState *)pQueue->arg;
+        pGPIO = (GPIO *)pTimer->arg;
+        if ( ( pState != NULL ) &&
+             ( pGPIO != NULL ) &&
+             ( pGPIO->pPattern != NULL ) &&
+             ( pGPIO->pPattern->nSteps > 0 ) )
+        {
+            pPattern = pGPIO->pPattern;
+            pGPIO->patternStep = ( pGPIO->patternStep + 1 ) % pPattern->nSteps;
+
+            /* the output is active during the even steps */
+            level = ( ( pGPIO->patternStep % 2 ) == 0 ) ? 1 : 0;
+            if ( pGPIO->value != level )
+            {
+                pState->stats.writesIssued++;
+                if ( gpiod_line_set_value( pGPIO->pLine, level ) == 0 )
+                {
+                    pGPIO->value = level;
+                }
+            }
+
+            /* schedule the end of the step */
+            due = pTimer->due +
+                  pPattern->steps[pGPIO->patternStep] * NS_PER_MS;
+            if ( due <= now )
+            {
+                /* resynchronize after the event loop was stalled,
+                   rather than replaying the missed steps */
+                due = now + pPattern->steps[pGPIO->patternStep] * NS_PER_MS;
+            }
+
+            (void)TimerStart( pQueue, pTimer, due );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  WriteGroup                                                                */
+/*!
+    Write the value of an output line group
+
+    The WriteGroup function splits the line group value into the bits of
+    its lines, and writes them with a single request, so all of the lines
+    change at the same time.  If the group lines could not be requested
+    together, the lines are written individually.
+
+@param[in]
+    pGroup
+        pointer to the line group to write
+
+@retval EOK the line group was written
+@retval EINVAL invalid arguments
+@retval other error writing the line group
+
+==============================================================================*/
+static int WriteGroup( LineGroup *pGroup )
+{
+    int result = EINVAL;
+    LineBank *pBank;
+    GPIO *pGPIO;
+    int rc;
+    int i;
+
+    if ( pGroup != NULL )
+    {
+        result = EOK;
+
+        for ( i = 0; i < pGroup->nLines; i++ )
+        {
+            pGPIO = pGroup->pLines[i];
+            pGPIO->value = ( pGroup->value >> pGPIO->groupBit ) & 1;
+
+            pBank = pGPIO->pBank;
+            if ( ( pBank != NULL ) &&
+                 ( pBank->requested == true ) )
+            {
+                pBank->values[pGPIO->bankIndex] = pGPIO->value;
+                pBank->dirty = true;
+            }
+            else if ( pGPIO->unusable == true )
+            {
+                /* the line could not be requested */
+                result = EIO;
+            }
+            else if ( gpiod_line_set_value( pGPIO->pLine,
+                                            pGPIO->value ) != 0 )
+            {
+                result = errno;
+            }
+        }
+
+        /* write all of the group lines together */
+        rc = WriteBanks( pGroup->pBank );
+        if ( rc != EOK )
+        {
+            result = rc;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdateGroupInput                                                          */
+/*!
+    Update an input line group
+
+    The UpdateGroupInput function writes the value of an input line group
+    to the group variable.  The value of a group which generates events
+    is kept up to date by its line events, otherwise all of the lines
+    of the group are read with a single request.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGroup
+        pointer to the line group to update
+
+@retval EOK the group variable was updated
+@retval ENOTSUP the group is not an input
+@retval EIO input error
+@retval EINVAL invalid arguments
+@retval other error reported by VAR_Set()
+
+==============================================================================*/
+static int UpdateGroupInput( GPIOCtrlState *pState, LineGroup *pGroup )
+{
+    int result = EINVAL;
+
+    if ( ( pState != NULL ) &&
+         ( pGroup != NULL ) &&
+         ( pGroup->nLines > 0 ) )
+    {
+        if ( pGroup->direction == GPIOD_LINE_DIRECTION_INPUT )
+        {
+            result = EOK;
+
+            if ( ( pGroup->pLines[0]->event_type == 0 ) ||
+                 ( pGroup->pBank == NULL ) ||
+                 ( pGroup->pBank->readTime == 0 ) )
+            {
+                /* read all of the group lines */
+                result = ReadGroup( pGroup );
+            }
+
+            if ( result == EOK )
+            {
+                result = WriteLineVar( pState, pGroup->pLines[0] );
+            }
+        }
+        else
+        {
+            /* unsupported action on this line group */
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadGroup                                                                 */
+/*!
+    Read the value of an input line group
+
+    The ReadGroup function reads all of the lines of an input line group
+    with a single request, and assembles their levels into the group
+    value.  If the group lines could not be requested together, the
+    lines are read individually.
+
+@param[in]
+    pGroup
+        pointer to the line group to read
+
+@retval EOK the line group was read
+@retval EIO input error
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ReadGroup( LineGroup *pGroup )
+{
+    int result = EINVAL;
+    LineBank *pBank;
+    GPIO *pGPIO;
+    uint64_t value = 0;
+    int level;
+    int i;
+
+    if ( pGroup != NULL )
+    {
+        result = EOK;
+        pBank = pGroup->pBank;
+
+        if ( ( pBank != NULL ) &&
+             ( pBank->requested == true ) )
+        {
+            /* read all of the group lines together */
+            result = ( ReadBank( pBank, GetMonotonicTime() ) == EOK )
+                     ? EOK
+                     : EIO;
+        }
+
+        for ( i = 0; ( i < pGroup->nLines ) && ( result == EOK ); i++ )
+        {
+            pGPIO = pGroup->pLines[i];
+            if ( ( pBank != NULL ) &&
+                 ( pBank->requested == true ) )
+            {
+                level = pBank->values[pGPIO->bankIndex];
+            }
+            else
+            {
+                level = ReadLineLevel( pGPIO );
+            }
+
+            if ( level < 0 )
+            {
+                result = EIO;
+            }
+            else
+            {
+                pGPIO->value = ( level > 0 ) ? 1 : 0;
+                value |= (uint64_t)pGPIO->value << pGPIO->groupBit;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pGroup->value = value;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdateInput                                                               */
+/*!
+    Update a GPIO input
+
+    The UpdateInput function will be find the variable given by it's handle,
+    get the current state of the associated GPIO input and update the
+    variable value with the appropriate input value.  If the variable is
+    associated with a line group, the group value is written to it.
+
+@param[in]
+    hVar
+        Handle for the variable associated with the GPIO output
+
+@param[in]
+    pState
+        pointer to a GPIOCtrlState object which contains the GPIO lines,
+        and a handle to the variable server
+
+@retval EOK the GPIO line was read correctly and the variable was updated
+@retval ENOENT the variable was not found
+@retval ENOTSUP the GPIO is not an input
+@retval EIO input error
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int UpdateInput( VAR_HANDLE hVar, GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    GPIO *pGPIO;
+    int direction;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        /* find the GPIO associated with the specified variable */
+        pGPIO = FindGPIO( pState, hVar );
+        if ( ( pGPIO != NULL ) &&
+             ( pGPIO->pGroup != NULL ) )
+        {
+            /* publish the group value */
+            result = UpdateGroupInput( pState, pGPIO->pGroup );
+        }
+        else if( pGPIO != NULL )
+        {
+            /* get the direction of this GPIO */
+            direction = pGPIO->direction;
+
+            if ( pGPIO->inputMode != INPUT_MODE_LEVEL )
+            {
+                /* publish the edge count or frequency */
+                result = WriteLineVar( pState, pGPIO );
+            }
+            else if ( direction == GPIOD_LINE_DIRECTION_INPUT )
+            {
+                /* read the GPIO line */
+                result = UpdatePolledInput( pState,
+                                            pGPIO,
+                                            GetMonotonicTime() );
+            }
+            else
+            {
+                /* unsupported action on this GPIO line */
+                result = ENOTSUP;
+            }
+        }
+        else
+        {
+            /* variable not found */
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdatePolledInput                                                         */
+/*!
+    Update the variable of a polled GPIO input
+
+    The UpdatePolledInput function reads the level of an input line and
+    writes it to the variable associated with the line.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGPIO
+        pointer to the GPIO input to update
+
+@param[in]
+    now
+        CLOCK_MONOTONIC time of the request in nanoseconds
+
+@retval EOK the GPIO line was read correctly and the variable was updated
+@retval EIO input error
+@retval EINVAL invalid arguments
+@retval other error reported by VAR_Set()
+
+==============================================================================*/
+static int UpdatePolledInput( GPIOCtrlState *pState,
+                              GPIO *pGPIO,
+                              uint64_t now )
+{
+    int result = EINVAL;
+    VarObject var;
+    int rc;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        /* read the GPIO line */
+        rc = ReadPolledInput( pState, pGPIO, now );
+        if ( rc != -1 )
+        {
+            /* set the value of the variable */
+            var.val.ui = ( rc > 0 ) ? 1 : 0;
+            var.type = VARTYPE_UINT16;
+            var.len = sizeof(uint16_t);
+
+            /* write to the variable */
+            result = VAR_Set( pState->hVarServer,
+                              pGPIO->hVar,
+                              &var );
+        }
+        else
+        {
+            /* input error when reading from the GPIO line */
+            result = EIO;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadPolledInput                                                           */
+/*!
+    Read the level of a polled GPIO input
+
+    The ReadPolledInput function gets the level of an input line when its
+    variable is requested.  A polled input which was requested in a line
+    bank returns the level from the last bank read if the bank was read
+    for another request made at the same time, or if the level is not
+    older than the maximum age of the line.  Otherwise all of the lines
+    in the bank are read with a single request, refreshing the cached
+    levels of every polled input in the bank.  Other inputs are read
+    directly.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGPIO
+        pointer to the GPIO input to read
+
+@param[in]
+    now
+        CLOCK_MONOTONIC time of the request in nanoseconds
+
+@retval 0 the line is inactive
+@retval 1 the line is active
+@retval -1 the line could not be read
+
+==============================================================================*/
+static int ReadPolledInput( GPIOCtrlState *pState,
+                            GPIO *pGPIO,
+                            uint64_t now )
+{
+    int level = -1;
+    LineBank *pBank;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        pBank = pGPIO->pBank;
+        if ( ( pBank != NULL ) &&
+             ( pBank->requested == true ) )
+        {
+            pState->stats.polls++;
+
+            if ( ( pBank->readTime == now ) ||
+                 ( ( pGPIO->maxAge > 0 ) &&
+                   ( pBank->readTime != 0 ) &&
+                   ( now - pBank->readTime <= pGPIO->maxAge ) ) )
+            {
+                /* the cached level is fresh enough */
+                pState->stats.pollHits++;
+                level = pBank->values[pGPIO->bankIndex];
+            }
+            else
+            {
+                /* refresh every polled input in the bank */
+                pState->stats.pollReads++;
+                if ( ReadBank( pBank, now ) == EOK )
+                {
+                    level = pBank->values[pGPIO->bankIndex];
+                }
+            }
+        }
+        else
+        {
+            level = ReadLineLevel( pGPIO );
+        }
+    }
+
+    return level;
+}
+
+/*============================================================================*/
+/*  PrintStatus                                                               */
+/*!
+    Print the GPIO controller status
+
+    The PrintStatus function iterates through the GPIO lines and
+    outputs a JSON object which lists the GPIO lines.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    fd
+        output file descriptor
+
+@retval EOK the GPIO status was printed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintStatus( GPIOCtrlState *pState, int fd )
+{
+    GPIOChip *pGPIOChip;
+    GPIO *pGPIO;
+    int result = EINVAL;
+
+    if ( ( pState != NULL ) &&
+         ( fd != -1 ) )
+    {
+        (void)write( fd, "[", 1 );
+
+        /* start looking in the first GPIO chip */
+        pGPIOChip = pState->pFirstGPIOChip;
+        while ( pGPIOChip != NULL )
+        {
+            if( pGPIOChip != pState->pFirstGPIOChip )
+            {
+                (void)write( fd, ",", 1 );
+            }
+
+            dprintf(fd, "{ \"chip\" : \"%s\", \"lines\" : [", pGPIOChip->name);
+
+            /* start looking in the first line of the chip */
+            pGPIO = pGPIOChip->pFirstLine;
+            while ( pGPIO != NULL )
+            {
+                if( pGPIO != pGPIOChip->pFirstLine )
+                {
+                    (void)write( fd, ",", 1 );
+                }
+
+                /* print the line information */
+                PrintLineInfo( pState, pGPIO, fd );
+
+                /* move on to the next GPIO line */
+                pGPIO = pGPIO->pNext;
+            }
+
+            /* close the chip */
+            (void)write( fd, "]}", 2 );
+
+            /* move to the next GPIO chip */
+            pGPIOChip = pGPIOChip->pNext;
+        }
+
+        (void)write( fd, "]", 1 );
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintStats                                                                */
+/*!
+    Print the GPIO controller statistics
+
+    The PrintStats function outputs a JSON object containing the
+    GPIO controller statistics.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    fd
+        output file descriptor
+
+@retval EOK the GPIO controller statistics were printed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintStats( GPIOCtrlState *pState, int fd )
+{
+    int result = EINVAL;
+    GPIOCtrlStats *pStats;
+    double eventsPerRead = 0.0;
+    double pollHitRate = 0.0;
+
+    if ( ( pState != NULL ) &&
+         ( fd != -1 ) )
+    {
+        pStats = &pState->stats;
+
+        if ( pStats->eventReads > 0 )
+        {
+            eventsPerRead = (double)pStats->events /
+                            (double)pStats->eventReads;
+        }
+
+        if ( pStats->polls > 0 )
+        {
+            pollHitRate = (double)pStats->pollHits /
+                          (double)pStats->polls;
+        }
+
+        dprintf( fd,
+                 "{ \"event_reads\" : %llu, "
+                 "\"events\" : %llu, "
+                 "\"events_per_read\" : %.2f, "
+                 "\"updates\" : %llu, "
+                 "\"coalesced\" : %llu, "
+                 "\"debounced\" : %llu, "
+                 "\"polls\" : %llu, "
+                 "\"poll_hits\" : %llu, "
+                 "\"poll_hit_rate\" : %.2f, "
+                 "\"poll_reads\" : %llu, "
+                 "\"writes_issued\" : %llu, "
+                 "\"writes_suppressed\" : %llu }",
+                 (unsigned long long)pStats->eventReads,
+                 (unsigned long long)pStats->events,
+                 eventsPerRead,
+                 (unsigned long long)pStats->updates,
+                 (unsigned long long)pStats->coalesced,
+                 (unsigned long long)pStats->debounced,
+                 (unsigned long long)pStats->polls,
+                 (unsigned long long)pStats->pollHits,
+                 pollHitRate,
+                 (unsigned long long)pStats->pollReads,
+                 (unsigned long long)pStats->writesIssued,
+                 (unsigned long long)pStats->writesSuppressed );
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintHistory                                                              */
+/*!
+    Print the GPIO line event histories
+
+    The PrintHistory function iterates through the GPIO lines and
+    outputs a JSON array containing the event history of each line
+    which has an event history ring.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    fd
+        output file descriptor
+
+@retval EOK the event histories were printed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintHistory( GPIOCtrlState *pState, int fd )
+{
+    GPIOChip *pGPIOChip;
+    GPIO *pGPIO;
+    int result = EINVAL;
+    int count = 0;
+
+    if ( ( pState != NULL ) &&
+         ( fd != -1 ) )
+    {
+        (void)write( fd, "[", 1 );
+
+        pGPIOChip = pState->pFirstGPIOChip;
+        while ( pGPIOChip != NULL )
+        {
+            pGPIO = pGPIOChip->pFirstLine;
+            while ( pGPIO != NULL )
+            {
+                if ( pGPIO->pHistory != NULL )
+                {
+                    if ( count++ > 0 )
+                    {
+                        (void)write( fd, ",", 1 );
+                    }
+
+                    dprintf( fd,
+                             "{ \"chip\" : \"%s\", ",
+                             pGPIOChip->name );
+
+                    PrintLineHistory( pGPIO, fd );
+                }
+
+                pGPIO = pGPIO->pNext;
+            }
+
+            pGPIOChip = pGPIOChip->pNext;
+        }
+
+        (void)write( fd, "]", 1 );
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintLineHistory                                                          */
+/*!
+    Print the event history of a GPIO line
+
+    The PrintLineHistory function completes a JSON object containing the
+    line number, variable name, total number of events, and the retained
+    events of a GPIO line, oldest first.
+
+@param[in]
+    pGPIO
+        pointer to the GPIO object to print
+
+@param[in]
+    fd
+        output file descriptor
+
+@retval EOK the event history was printed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintLineHistory( GPIO *pGPIO, int fd )
+{
+    int result = EINVAL;
+    HistoryEntry *pEntry;
+    uint64_t first;
+    uint64_t seq;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pGPIO->pHistory != NULL ) &&
+         ( fd != -1 ) )
+    {
+        dprintf( fd,
+                 "\"line\" : %d, \"var\" : \"%s\", "
+                 "\"total\" : %llu, \"events\" : [",
+                 pGPIO->line_num,
+                 pGPIO->name,
+                 (unsigned long long)pGPIO->historySeq );
+
+        /* start at the oldest event retained in the ring */
+        first = ( pGPIO->historySeq > HISTORY_SIZE )
+                ? pGPIO->historySeq - HISTORY_SIZE
+                : 0;
+
+        for ( seq = first; seq < pGPIO->historySeq; seq++ )
+        {
+            pEntry = &pGPIO->pHistory[seq & HISTORY_MASK];
+            dprintf( fd,
+                     "%s{ \"seq\" : %llu, \"timestamp\" : %llu, "
+                     "\"edge\" : \"%s\" }",
+                     ( seq != first ) ? "," : "",
+                     (unsigned long long)pEntry->seq,
+                     (unsigned long long)pEntry->timestamp,
+                     ( pEntry->level == 1 ) ? "rising" : "falling" );
+        }
+
+        (void)write( fd, "]}", 2 );
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintLineInfo                                                             */
+/*!
+    Print the GPIO line information
+
+    The PrintLineInfo function prints a JSON object containing the
+    GPIO line information
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+@param[in]
+    pGPIO
+        pointer to the GPIO object to print
+
+@param[in]
+    fd
+        output file descriptor
+
+@retval EOK the GPIO line information was printed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintLineInfo( GPIOCtrlState *pState, GPIO *pGPIO, int fd )
+{
+    GPIOChip *pGPIOChip;
+    int result = EINVAL;
+    const char *line_name;
+    uint64_t remaining;
+    uint64_t now;
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( fd != -1 ) )
+    {
+        if ( pGPIO->pLine != NULL )
+        {
+            /* get the line name */
+            line_name = gpiod_line_name( pGPIO->pLine );
+
+            dprintf( fd,
+                     "{ \"line\" : %d, "
+                     "\"name\" : \"%s\", "
+                     "\"var\" : \"%s\"",
+                     pGPIO->line_num,
+                     ( line_name != NULL ) ? line_name : "unknown",
+                     pGPIO->name);
+
+            if ( pGPIO->pGroup != NULL )
+            {
+                /* print the line group bit */
+                dprintf( fd,
+                         ", \"group\" : { \"bit\" : %d, "
+                         "\"value\" : %llu }",
+                         pGPIO->groupBit,
+                         (unsigned long long)pGPIO->pGroup->value );
+            }
+            else if ( pGPIO->inputMode == INPUT_MODE_COUNTER )
+            {
+                /* print the edge count */
+                dprintf( fd,
+                         ", \"count\" : %llu",
+                         (unsigned long long)pGPIO->count );
+            }
+            else if ( ( pGPIO->inputMode == INPUT_MODE_ENCODER ) &&
+                      ( pGPIO->pEncoder != NULL ) )
+            {
+                /* print the encoder state */
+                dprintf( fd,
+                         ", \"encoder\" : { \"channel\" : \"%s\", "
+                         "\"position\" : %lld, "
+                         "\"illegal\" : %llu, "
+                         "\"errors\" : %llu }",
+                         ( pGPIO == pGPIO->pEncoder->pA ) ? "a" : "b",
+                         (long long)pGPIO->pEncoder->position,
+                         (unsigned long long)pGPIO->pEncoder->illegal,
+                         (unsigned long long)pGPIO->pEncoder->errors );
+            }
+            else if ( pGPIO->inputMode == INPUT_MODE_PULSE_WIDTH )
+            {
+                /* print the measured pulse width */
+                dprintf( fd,
+                         ", \"high_us\" : %.3f, \"low_us\" : %.3f",
+                         (double)pGPIO->pulseHigh / (double)NS_PER_US,
+                         (double)pGPIO->pulseLow / (double)NS_PER_US );
+            }
+            else if ( pGPIO->inputMode == INPUT_MODE_FREQUENCY )
+            {
+                /* print the measured frequency */
+                dprintf( fd,
+                         ", \"frequency\" : %.3f",
+                         pGPIO->frequency );
+            }
+
+            if ( pGPIO->debounceInterval > 0 )
+            {
+                /* print where the input is debounced */
+                dprintf( fd,
+                         ", \"debounce\" : \"%s\"",
+                         ( pGPIO->kernelDebounce == true ) ? "kernel"
+                                                           : "software" );
+            }
+
+            if ( pGPIO->PWM == true )
+            {
+                /* print the PWM timing */
+                PrintPWMInfo( pGPIO, fd );
+            }
+            else if ( pGPIO->outputMode == OUTPUT_MODE_PULSE )
+            {
+                /* print the pulse state */
+                now = GetMonotonicTime();
+                remaining = ( ( pGPIO->value != 0 ) &&
+                              ( pGPIO->oneShotEnd > now ) )
+                            ? pGPIO->oneShotEnd - now
+                            : 0;
+
+                dprintf( fd,
+                         ", \"pulse\" : { \"active\" : %s, "
+                         "\"remaining_us\" : %llu }",
+                         ( pGPIO->value != 0 ) ? "true" : "false",
+                         (unsigned long long)( remaining / NS_PER_US ) );
+            }
+            else if ( ( pGPIO->outputMode == OUTPUT_MODE_PATTERN ) &&
+                      ( pGPIO->pPattern != NULL ) )
+            {
+                /* print the selected pattern */
+                dprintf( fd,
+                         ", \"pattern\" : { \"name\" : \"%s\", "
+                         "\"step\" : %zu }",
+                         pGPIO->pPattern->name,
+                         pGPIO->patternStep );
+            }
+
+            (void)write( fd, "}", 1 );
+        }
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PrintPWMInfo                                                              */
+/*!
+    Print the PWM timing information
+
+    The PrintPWMInfo function prints a JSON attribute containing the
+    configured and achieved timing of a PWM line.  For a software PWM
+    line, the achieved
+    frequency is measured from the start times of the PWM periods, and
+    the jitter is the latency between the time each edge was due and
+    the time it was processed.  Overruns count the periods which were
+    re-aligned because the scheduler fell more than a full period behind.
+    A large jitter or any overruns indicate the software PWM limit has
+    been reached.
+
+@param[in]
+    pGPIO
+        pointer to the PWM GPIO object to print
+
+@param[in]
+    fd
+        output file descriptor
+
+@retval EOK the software PWM information was printed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int PrintPWMInfo( GPIO *pGPIO, int fd )
+{
+    int result = EINVAL;
+    double frequency = 0.0;
+    double achieved = 0.0;
+    double jitter = 0.0;
+    uint64_t elapsed;
+    uint64_t cycles;
+    uint64_t edges;
+    uint64_t latencySum;
+    uint64_t latencyMax;
+    uint64_t overruns;
+
+    if ( ( pGPIO != NULL ) &&
+         ( fd != -1 ) )
+    {
+        if ( pGPIO->pwmPeriod > 0 )
+        {
+            frequency = (double)NS_PER_SEC / (double)pGPIO->pwmPeriod;
+        }
+
+        /* the statistics are updated by the PWM scheduler thread while
+         * they are being read, so the values may be an edge apart */
+        cycles = atomic_load_explicit( &pGPIO->pwmCycles,
+                                       memory_order_relaxed );
+        elapsed = atomic_load_explicit( &pGPIO->pwmLastStart,
+                                        memory_order_relaxed ) -
+                  atomic_load_explicit( &pGPIO->pwmFirstStart,
+                                        memory_order_relaxed );
+        edges = atomic_load_explicit( &pGPIO->pwmEdges,
+                                      memory_order_relaxed );
+        latencySum = atomic_load_explicit( &pGPIO->pwmLatencySum,
+                                           memory_order_relaxed );
+        latencyMax = atomic_load_explicit( &pGPIO->pwmLatencyMax,
+                                           memory_order_relaxed );
+        overruns = atomic_load_explicit( &pGPIO->pwmOverruns,
+                                         memory_order_relaxed );
+
+        if ( ( cycles > 1 ) && ( elapsed > 0 ) )
+        {
+            achieved = (double)( cycles - 1 ) *
+                       (double)NS_PER_SEC / (double)elapsed;
+        }
+
+        if ( edges > 0 )
+        {
+            jitter = (double)latencySum /
+                     (double)edges /
+                     (double)NS_PER_US;
+        }
+
+        if ( pGPIO->pwmHardware == true )
+        {
+            dprintf( fd,
+                     ", \"pwm\" : { "
+                     "\"backend\" : \"hardware\", "
+                     "\"pwmchip\" : %d, "
+                     "\"channel\" : %d, "
+                     "\"frequency\" : %.3f, "
+                     "\"resolution\" : %d }",
+                     pGPIO->pwmChip,
+                     pGPIO->pwmChannel,
+                     frequency,
+                     pGPIO->pwmResolution );
+        }
+        else
+        {
+            dprintf( fd,
+                     ", \"pwm\" : { "
+                     "\"backend\" : \"software\", "
+                     "\"frequency\" : %.3f, "
+                     "\"resolution\" : %d, "
+                     "\"achieved_frequency\" : %.3f, "
+                     "\"jitter_avg_us\" : %.1f, "
+                     "\"jitter_max_us\" : %.1f, "
+                     "\"overruns\" : %llu }",
+                     frequency,
+                     pGPIO->pwmResolution,
+                     achieved,
+                     jitter,
+                     (double)latencyMax / (double)NS_PER_US,
+                     (unsigned long long)overruns );
+        }
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/* Shutdown                                                                   */
+/*!
+    Shutdown the GPIO control service
+
+    The Shutdown service iterates through all of the GPIO resources
+    and closes and deallocates them.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state
+
+==============================================================================*/
+static void Shutdown( GPIOCtrlState *pState )
+{
+    GPIOChip *pGPIOChip;
+    GPIOChip *pTempGPIOChip;
+    GPIO *pGPIO;
+    GPIO *pTempGPIO;
+    Encoder *pEncoder;
+    LineGroup *pGroup;
+
+    if ( pState != NULL )
+    {
+        /* start looking in the first GPIO chip */
+        pGPIOChip = pState->pFirstGPIOChip;
+        while ( pGPIOChip != NULL )
+        {
+            /* start looking in the first line of the chip */
+            pGPIO = pGPIOChip->pFirstLine;
+            while ( pGPIO != NULL )
+            {
+                pTempGPIO = pGPIO;
+
+                /* move on to the next GPIO line */
+                pGPIO = pGPIO->pNext;
+
+                if ( pTempGPIO->pLine != NULL )
+                {
+                    gpiod_line_release( pTempGPIO->pLine );
+                }
+
+                if ( pTempGPIO->pwmHardware == true )
+                {
+                    /* close the hardware PWM duty cycle */
+                    close( pTempGPIO->pwmDutyFd );
+                }
+
+                if ( pTempGPIO->lineFd != -1 )
+                {
+                    /* release the GPIO v2 uAPI line request */
+                    close( pTempGPIO->lineFd );
+                }
+
+                /* free the GPIO line object and its event history */
+                free( pTempGPIO->pHistory );
+                free( pTempGPIO );
+            }
+
+            pTempGPIOChip = pGPIOChip;
+
+            if( pTempGPIOChip->pChip != NULL )
+            {
+                gpiod_chip_close( pTempGPIOChip->pChip );
+            }
+
+            /* move to the next GPIO chip */
+            pGPIOChip = pGPIOChip->pNext;
+        }
+
+        /* free the dispatch table */
+        free( pState->pGPIOTable );
+        pState->pGPIOTable = NULL;
+        pState->nGPIOTable = 0;
+
+        /* free the event reverse index */
+        free( pState->pEventTable );
+        pState->pEventTable = NULL;
+        pState->nEventTable = 0;
+
+        /* close the event loop */
+        if ( pState->epfd != -1 )
+        {
+            close( pState->epfd );
+            pState->epfd = -1;
+        }
+
+        if ( pState->sigfd != -1 )
+        {
+            close( pState->sigfd );
+            pState->sigfd = -1;
+        }
+
+        if ( pState->timerfd != -1 )
+        {
+            close( pState->timerfd );
+            pState->timerfd = -1;
+        }
+
+        /* free the event loop timers */
+        free( pState->eventQueue.pTimers );
+        pState->eventQueue.pTimers = NULL;
+        pState->eventQueue.n = 0;
+        pState->eventQueue.size = 0;
+
+        /* free the line banks */
+        FreeBanks( &pState->pFirstPWMBank );
+        FreeBanks( &pState->pFirstInputBank );
+
+        /* free the quadrature encoders */
+        while ( pState->pFirstEncoder != NULL )
+        {
+            pEncoder = pState->pFirstEncoder;
+            pState->pFirstEncoder = pEncoder->pNext;
+            free( pEncoder );
+        }
+
+        /* free the line groups */
+        while ( pState->pFirstGroup != NULL )
+        {
+            pGroup = pState->pFirstGroup;
+            pState->pFirstGroup = pGroup->pNext;
+            FreeBanks( &pGroup->pBank );
+            free( pGroup );
+        }
+    }
+
+    pState->pFirstGPIOChip = NULL;
+    pState->pLastGPIOChip = NULL;
+}
+
+/*============================================================================*/
+/*  CreatePWM                                                                 */
+/*!
+    Create a software PWM output
+
+    The CreatePWM function adds a software PWM line to the PWM edge
+    schedule.  All software PWM lines are driven by a single scheduler
+    thread which sleeps until the next edge due on any line, so the
+    CPU overhead scales with the number of edges rather than the number
+    of PWM lines.
+
+    PWM lines on the same chip are grouped into line banks so that edges
+    which coincide across lines can be written with a single request.
+    The PWM line's first period starts as soon as the scheduler is started.
+
+    If the line is configured to use a hardware PWM backend, the hardware
+    PWM channel is set up instead.  If the "auto" backend is selected and
+    the hardware PWM channel is not available, the line falls back to
+    the software PWM.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state containing the PWM schedule
+
+@param[in]
+    pGPIO
+        pointer to the GPIO pin to add to the PWM schedule
+
+@retval EOK the PWM line was added to the schedule
+@retval ENOMEM the PWM schedule or line bank could not be grown
+@retval EINVAL invalid arguments
+@retval other error from setting up the hardware PWM channel
+
+==============================================================================*/
+static int CreatePWM( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    bool software = true;
+
     if ( ( pState != NULL ) &&
-         ( pLine != NULL ) )
+         ( pGPIO != NULL ) &&
+         ( pGPIO->pwmBackend != PWM_BACKEND_SOFTWARE ) )
     {
-        /* start looking in the first GPIO chip */
-        pGPIOChip = pState->pFirstGPIOChip;
-        while ( ( pGPIOChip != NULL ) && ( found == false ) )
+        /* set up the hardware PWM channel */
+        result = CreateHardwarePWM( pState, pGPIO );
+        if ( result != EOK )
         {
-            /* start looking in the first line of the chip */
-            pGPIO = pGPIOChip->pFirstLine;
-            while( ( pGPIO != NULL ) && ( found == false ) )
+            syslog( LOG_ERR,
+                    "unable to set up pwmchip%d/pwm%d for %s: %s",
+                    pGPIO->pwmChip,
+                    pGPIO->pwmChannel,
+                    pGPIO->name,
+                    strerror( result ) );
+        }
+
+        /* only fall back to the software PWM in auto mode */
+        software = ( ( result != EOK ) &&
+                     ( pGPIO->pwmBackend == PWM_BACKEND_AUTO ) );
+    }
+
+    if ( ( pState != NULL ) &&
+         ( pGPIO != NULL ) &&
+         ( software == true ) )
+    {
+        TimerInit( &pGPIO->pwmTimer, PWMEdge, pGPIO );
+        atomic_init( &pGPIO->pwmValue, pGPIO->value );
+        pGPIO->pwmLevel = 0;
+        pGPIO->pwmFalling = false;
+
+        /* add the line to a bank of PWM lines on the same chip */
+        result = AddBankLine( &pState->pFirstPWMBank,
+                              pState->pLastGPIOChip,
+                              pGPIO );
+        if ( result == EOK )
+        {
+            /* the period start times are assigned when the
+             * scheduler starts */
+            result = TimerStart( &pState->pwmQueue, &pGPIO->pwmTimer, 0 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StartPWMScheduler                                                         */
+/*!
+    Start the software PWM scheduler
+
+    The StartPWMScheduler function requests the banks of software PWM
+    lines, aligns the first period of every software PWM line to the
+    current time and starts the PWM scheduler thread.  If there are no
+    software PWM lines, no thread is created.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state containing the PWM schedule
+
+@retval EOK the PWM scheduler was started
+@retval ENOENT there are no software PWM lines
+@retval EINVAL invalid arguments
+@retval other error returned by pthread_create
+
+==============================================================================*/
+static int StartPWMScheduler( GPIOCtrlState *pState )
+{
+    int result = EINVAL;
+    uint64_t now;
+    size_t i;
+    pthread_condattr_t attr;
+
+    if ( pState != NULL )
+    {
+        if ( pState->pwmQueue.n > 0 )
+        {
+            /* the scheduler thread waits for the edges on the same
+             * clock as the edges are scheduled */
+            pthread_mutex_init( &pState->pwmLock, NULL );
+            pthread_condattr_init( &attr );
+            pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+            pthread_cond_init( &pState->pwmWake, &attr );
+            pthread_condattr_destroy( &attr );
+
+            /* request the PWM lines */
+            RequestBanks( pState->pFirstPWMBank );
+
+            /* start all PWM periods together */
+            now = GetMonotonicTime();
+            for ( i = 0; i < pState->pwmQueue.n; i++ )
             {
-                /* check for a gpiod line match */
-                if( pGPIO->pLine == pLine )
-                {
-                    /* save the found GPIO variable */
-                    hVar = pGPIO->hVar;
+                pState->pwmQueue.pTimers[i]->due = now;
+            }
 
-                    /* abort the search */
-                    found = true;
+            atomic_store( &pState->pwmRunning, true );
+            result = pthread_create( &pState->pwmThread,
+                                     NULL,
+                                     PWMThread,
+                                     (void *)pState );
+            if ( result != EOK )
+            {
+                atomic_store( &pState->pwmRunning, false );
+                pthread_cond_destroy( &pState->pwmWake );
+                pthread_mutex_destroy( &pState->pwmLock );
+                syslog( LOG_ERR,
+                        "unable to start PWM scheduler: %s",
+                        strerror( result ) );
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StopPWMScheduler                                                          */
+/*!
+    Stop the software PWM scheduler
+
+    The StopPWMScheduler function stops the software PWM scheduler
+    thread and waits for it to terminate, so the PWM lines may be
+    safely released.  The thread is woken from its wait for the next
+    edge, so stopping does not wait for the longest PWM period.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state containing the PWM schedule
+
+==============================================================================*/
+static void StopPWMScheduler( GPIOCtrlState *pState )
+{
+    if ( ( pState != NULL ) &&
+         ( atomic_load( &pState->pwmRunning ) == true ) )
+    {
+        /* clear the running flag while the thread is waiting so the
+         * wake up cannot be lost */
+        pthread_mutex_lock( &pState->pwmLock );
+        atomic_store( &pState->pwmRunning, false );
+        pthread_cond_signal( &pState->pwmWake );
+        pthread_mutex_unlock( &pState->pwmLock );
+
+        pthread_join( pState->pwmThread, NULL );
+        pthread_cond_destroy( &pState->pwmWake );
+        pthread_mutex_destroy( &pState->pwmLock );
+    }
+
+    if ( pState != NULL )
+    {
+        free( pState->pwmQueue.pTimers );
+        pState->pwmQueue.pTimers = NULL;
+        pState->pwmQueue.n = 0;
+        pState->pwmQueue.size = 0;
+    }
+}
+
+/*============================================================================*/
+/*  PWMThread                                                                 */
+/*!
+    PWM scheduler thread
+
+    The PWM scheduler thread drives all of the software PWM lines.
+    It waits on the monotonic clock until the absolute time of the next
+    edge due across all PWM lines, or until it is woken by
+    StopPWMScheduler, and then processes every edge which is due within
+    the current scheduling tick.  Each edge handler schedules the following
+    edge for its line.  The new line values are then written with one
+    request per bank of PWM lines, so coincident edges on the same chip
+    are applied together.
+
+@param[in]
+    arg
+        pointer to the GPIO controller state containing the PWM schedule
+
+==============================================================================*/
+static void *PWMThread( void *arg )
+{
+    GPIOCtrlState *pState = (GPIOCtrlState *)arg;
+    TimerQueue *pQueue;
+    Timer *pTimer;
+    struct timespec ts;
+    uint64_t now;
+    sigset_t mask;
+    int rc;
+
+    /* block real time signals on this thread, and leave the termination
+     * signals to interrupt the event loop on the main thread */
+    sigemptyset( &mask );
+    sigaddset( &mask, SIG_VAR_MODIFIED );
+    sigaddset( &mask, SIG_VAR_CALC );
+    sigaddset( &mask, SIG_VAR_PRINT );
+    sigaddset( &mask, SIGTERM );
+    sigaddset( &mask, SIGINT );
+    pthread_sigmask( SIG_BLOCK, &mask, NULL );
+
+    /* request the finest timer resolution for the PWM edges */
+    prctl( PR_SET_TIMERSLACK, 1UL );
+
+    if( pState != NULL )
+    {
+        pQueue = &pState->pwmQueue;
+
+        pthread_mutex_lock( &pState->pwmLock );
+
+        while ( atomic_load( &pState->pwmRunning ) == true )
+        {
+            pTimer = TimerNext( pQueue );
+            if ( pTimer == NULL )
+            {
+                break;
+            }
+
+            /* wait until the next edge is due or the scheduler is
+             * stopped.  Any other wake up checks the flag and waits
+             * again */
+            ts.tv_sec = pTimer->due / NS_PER_SEC;
+            ts.tv_nsec = pTimer->due % NS_PER_SEC;
+            rc = pthread_cond_timedwait( &pState->pwmWake,
+                                         &pState->pwmLock,
+                                         &ts );
+            if ( rc != ETIMEDOUT )
+            {
+                continue;
+            }
+
+            /* process all of the edges which are due in this tick.
+             * Edges scheduled by the handlers are processed on the
+             * next pass, so each line changes at most once per write */
+            now = GetMonotonicTime();
+            TimerDispatch( pQueue, now, now + PWM_TICK_NS );
+
+            /* apply the edges to the hardware */
+            WriteBanks( pState->pFirstPWMBank );
+        }
+
+        pthread_mutex_unlock( &pState->pwmLock );
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  PWMEdge                                                                   */
+/*!
+    Process a software PWM edge
+
+    The PWMEdge function is the timer handler for a software PWM line.
+    At the start of each period it samples the value handed over by the
+    main thread to get the duty cycle in the range [0..2^resolution - 1],
+    drives the line high, and schedules the falling edge.  At the falling
+    edge it drives the line low and schedules the start of the next
+    period.  A value of 0 keeps the line low and the full scale value
+    keeps the line high for the whole period.
+
+    The latency of each edge and the period start times are recorded
+    so the achieved PWM frequency and jitter can be reported.
+
+    Edge times are computed from the absolute period start time rather
+    than the time the edge was processed, so scheduling latency does not
+    accumulate from one period to the next.  If the scheduler falls more
+    than a full period behind, the period is re-aligned to the current
+    time.
+
+    If the line is in a bank of PWM lines, the new level is recorded in the
+    bank and written by the scheduler once all coincident edges have been
+    processed.
+
+@param[in]
+    pQueue
+        pointer to the PWM edge schedule
+
+@param[in]
+    pTimer
+        pointer to the PWM edge timer which expired
+
+@param[in]
+    now
+        current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static void PWMEdge( TimerQueue *pQueue, Timer *pTimer, uint64_t now )
+{
+    GPIO *pGPIO;
+    LineBank *pBank;
+    uint64_t period;
+    uint64_t high;
+    uint64_t latency;
+    int value;
+    int level;
+    uint64_t due;
+
+    if ( ( pTimer != NULL ) &&
+         ( pTimer->arg != NULL ) )
+    {
+        pGPIO = (GPIO *)pTimer->arg;
+        period = pGPIO->pwmPeriod;
+
+        /* record the edge latency */
+        latency = ( now > pTimer->due ) ? now - pTimer->due : 0;
+        atomic_fetch_add_explicit( &pGPIO->pwmLatencySum,
+                                   latency,
+                                   memory_order_relaxed );
+        atomic_fetch_add_explicit( &pGPIO->pwmEdges,
+                                   1,
+                                   memory_order_relaxed );
+        if ( latency > atomic_load_explicit( &pGPIO->pwmLatencyMax,
+                                             memory_order_relaxed ) )
+        {
+            atomic_store_explicit( &pGPIO->pwmLatencyMax,
+                                   latency,
+                                   memory_order_relaxed );
+        }
+
+        if ( pGPIO->pwmFalling == true )
+        {
+            /* end of the high phase */
+            level = 0;
+            pGPIO->pwmFalling = false;
+            due = pGPIO->pwmPeriodStart + period;
+        }
+        else
+        {
+            /* start of a new period */
+            pGPIO->pwmPeriodStart = pTimer->due;
+            if ( now >= pGPIO->pwmPeriodStart + period )
+            {
+                /* we have fallen a whole period behind */
+                pGPIO->pwmPeriodStart = now;
+                atomic_fetch_add_explicit( &pGPIO->pwmOverruns,
+                                           1,
+                                           memory_order_relaxed );
+            }
+
+            if ( atomic_load_explicit( &pGPIO->pwmCycles,
+                                       memory_order_relaxed ) == 0 )
+            {
+                atomic_store_explicit( &pGPIO->pwmFirstStart,
+                                       now,
+                                       memory_order_relaxed );
+            }
+
+            atomic_store_explicit( &pGPIO->pwmLastStart,
+                                   now,
+                                   memory_order_relaxed );
+            atomic_fetch_add_explicit( &pGPIO->pwmCycles,
+                                       1,
+                                       memory_order_relaxed );
+
+            /* limit the value to [0..pwmMax] */
+            value = atomic_load_explicit( &pGPIO->pwmValue,
+                                          memory_order_relaxed );
+            value = ( value < 0 ) ? 0 : value;
+            value = ( value > pGPIO->pwmMax ) ? pGPIO->pwmMax : value;
+
+            high = ( (uint64_t)value * period ) / (uint64_t)pGPIO->pwmMax;
+            level = ( high > 0 ) ? 1 : 0;
+
+            if ( ( high > 0 ) && ( high < period ) )
+            {
+                pGPIO->pwmFalling = true;
+                due = pGPIO->pwmPeriodStart + high;
+            }
+            else
+            {
+                due = pGPIO->pwmPeriodStart + period;
+            }
+        }
+
+        if ( level != pGPIO->pwmLevel )
+        {
+            pGPIO->pwmLevel = level;
+
+            pBank = pGPIO->pBank;
+            if ( ( pBank != NULL ) &&
+                 ( pBank->requested == true ) )
+            {
+                /* defer the write until all coincident edges
+                 * have been processed */
+                pBank->values[pGPIO->bankIndex] = level;
+                pBank->dirty = true;
+            }
+            else if ( pGPIO->unusable == false )
+            {
+                /* set the output value to the hardware */
+                gpiod_line_set_value( pGPIO->pLine, level );
+            }
+        }
+
+        /* schedule the next edge */
+        TimerStart( pQueue, pTimer, due );
+    }
+}
+
+/*============================================================================*/
+/*  CreateHardwarePWM                                                         */
+/*!
+    Set up a hardware PWM channel
+
+    The CreateHardwarePWM function exports the line's hardware PWM channel
+    via the sysfs pwmchip interface if it is not already exported, sets its
+    period and initial duty cycle, and enables it.  The duty_cycle attribute
+    is kept open so the duty cycle can be updated with a single write when
+    the line's variable changes.  Once enabled, the hardware PWM requires
+    no CPU time.
+
+@param[in]
+    pState
+        pointer to the GPIO controller state containing the sysfs location
+
+@param[in]
+    pGPIO
+        pointer to the GPIO object of the hardware PWM line
+
+@retval EOK the hardware PWM channel was set up
+@retval ENOENT the hardware PWM channel does not exist
+@retval ENAMETOOLONG the sysfs root is too long for the channel paths
+@retval EINVAL invalid arguments
+@retval other error writing to the sysfs pwmchip interface
+
+==============================================================================*/
+static int CreateHardwarePWM( GPIOCtrlState *pState, GPIO *pGPIO )
+{
+    int result = EINVAL;
+    char chip[PATH_MAX];
+    char channel[PATH_MAX];
+    char duty[PATH_MAX];
+    char buf[32];
+    struct stat sb;
+    int retries = PWM_EXPORT_RETRIES;
+
+    if ( ( pState != NULL ) &&
+         ( pState->pPWMSysfs != NULL ) &&
+         ( pGPIO != NULL ) )
+    {
+        if ( ( (size_t)snprintf( chip,
+                                 sizeof( chip ),
+                                 "%s/pwmchip%d",
+                                 pState->pPWMSysfs,
+                                 pGPIO->pwmChip ) >= sizeof( chip ) ) ||
+             ( (size_t)snprintf( channel,
+                                 sizeof( channel ),
+                                 "%s/pwm%d",
+                                 chip,
+                                 pGPIO->pwmChannel ) >= sizeof( channel ) ) ||
+             ( (size_t)snprintf( duty,
+                                 sizeof( duty ),
+                                 "%s/duty_cycle",
+                                 channel ) >= sizeof( duty ) ) )
+        {
+            /* the sysfs root is too long for the channel paths */
+            result = ENAMETOOLONG;
+        }
+        else if ( stat( chip, &sb ) != 0 )
+        {
+            /* the PWM chip does not exist */
+            result = ENOENT;
+        }
+        else
+        {
+            result = EOK;
+
+            if ( stat( channel, &sb ) != 0 )
+            {
+                /* export the PWM channel */
+                snprintf( buf, sizeof( buf ), "%d", pGPIO->pwmChannel );
+                result = WriteSysfs( chip, "export", buf );
+
+                /* wait for the channel attributes to become available */
+                while ( ( result == EOK ) &&
+                        ( stat( channel, &sb ) != 0 ) )
+                {
+                    if ( --retries == 0 )
+                    {
+                        result = ENOENT;
+                    }
+                    else
+                    {
+                        usleep( 10000 );
+                    }
                 }
+            }
+        }
 
-                /* move on to the next GPIO line */
-                pGPIO = pGPIO->pNext;
+        if ( result == EOK )
+        {
+            /* clear the duty cycle so it cannot exceed the new period */
+            result = WriteSysfs( channel, "duty_cycle", "0" );
+        }
+
+        if ( result == EOK )
+        {
+            snprintf( buf,
+                      sizeof( buf ),
+                      "%llu",
+                      (unsigned long long)pGPIO->pwmPeriod );
+            result = WriteSysfs( channel, "period", buf );
+        }
+
+        if ( result == EOK )
+        {
+            result = WriteSysfs( channel, "enable", "1" );
+        }
+
+        if ( result == EOK )
+        {
+            /* keep the duty cycle open for updates */
+            pGPIO->pwmDutyFd = open( duty, O_WRONLY | O_CLOEXEC );
+            if ( pGPIO->pwmDutyFd != -1 )
+            {
+                pGPIO->pwmHardware = true;
+                result = SetHardwarePWM( pGPIO );
+            }
+            else
+            {
+                result = errno;
             }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetHardwarePWM                                                            */
+/*!
+    Set the duty cycle of a hardware PWM channel
+
+    The SetHardwarePWM function converts the line value in the range
+    [0..2^resolution - 1] to a duty cycle in nanoseconds and writes it to
+    the hardware PWM channel's duty_cycle attribute.
+
+@param[in]
+    pGPIO
+        pointer to the GPIO object of the hardware PWM line
+
+@retval EOK the duty cycle was written
+@retval EINVAL invalid arguments
+@retval other error writing to the duty_cycle attribute
+
+==============================================================================*/
+static int SetHardwarePWM( GPIO *pGPIO )
+{
+    int result = EINVAL;
+    char buf[32];
+    uint64_t duty;
+    int value;
+    int n;
+
+    if ( ( pGPIO != NULL ) &&
+         ( pGPIO->pwmDutyFd != -1 ) &&
+         ( pGPIO->pwmMax > 0 ) )
+    {
+        /* limit the value to [0..pwmMax] */
+        value = pGPIO->value;
+        value = ( value < 0 ) ? 0 : value;
+        value = ( value > pGPIO->pwmMax ) ? pGPIO->pwmMax : value;
+
+        duty = ( (uint64_t)value * pGPIO->pwmPeriod ) /
+               (uint64_t)pGPIO->pwmMax;
 
-            /* move to the next GPIO chip */
-            pGPIOChip = pGPIOChip->pNext;
-        }
+        n = snprintf( buf, sizeof( buf ), "%llu", (unsigned long long)duty );
+        result = ( pwrite( pGPIO->pwmDutyFd, buf, n, 0 ) == n ) ? EOK : errno;
     }
 
-    return hVar;
+    return result;
 }
 
-/*==========================================================================*/
-/*  usage                                                                   */
+/*============================================================================*/
+/*  WriteSysfs                                                                */
 /*!
-    Display the application usage
+    Write a sysfs attribute
 
-    The usage function dumps the application usage message
-    to stderr.
+    The WriteSysfs function writes a string value to the named attribute
+    in the specified sysfs directory.
 
-    @param[in]
-       cmdname
-            pointer to the invoked command name
+@param[in]
+    dir
+        pointer to the sysfs directory name
 
-    @return none
+@param[in]
+    attr
+        pointer to the attribute name
 
-============================================================================*/
-static void usage( char *cmdname )
+@param[in]
+    value
+        pointer to the NUL terminated value to write
+
+@retval EOK the attribute was written
+@retval ENAMETOOLONG the attribute path is too long
+@retval EINVAL invalid arguments
+@retval other error opening or writing the attribute
+
+==============================================================================*/
+static int WriteSysfs( const char *dir, const char *attr, const char *value )
 {
-    if( cmdname != NULL )
+    int result = EINVAL;
+    char path[PATH_MAX];
+    size_t len;
+    int fd;
+
+    if ( ( dir != NULL ) &&
+         ( attr != NULL ) &&
+         ( value != NULL ) )
     {
-        fprintf(stderr,
-                "usage: %s [-v] [-h] "
-                " [-h] : display this help"
-                " [-v] : verbose output"
-                " -f <filename> : configuration file",
-                cmdname );
+        if ( (size_t)snprintf( path, sizeof( path ), "%s/%s", dir, attr ) >=
+             sizeof( path ) )
+        {
+            /* the attribute path does not fit */
+            result = ENAMETOOLONG;
+        }
+        else
+        {
+            fd = open( path, O_WRONLY | O_CLOEXEC );
+            if ( fd != -1 )
+            {
+                len = strlen( value );
+                result = ( write( fd, value, len ) == (ssize_t)len ) ? EOK
+                                                                     : errno;
+                close( fd );
+            }
+            else
+            {
+                result = errno;
+            }
+        }
     }
+
+    return result;
 }
 
-/*==========================================================================*/
-/*  ProcessOptions                                                          */
+/*============================================================================*/
+/*  AddBankLine                                                               */
 /*!
-    Process the command line options
+    Add a GPIO line to a line bank
 
-    The ProcessOptions function processes the command line options and
-    populates the GPIOCtrlState object
+    The AddBankLine function adds the GPIO line to a line bank in the
+    specified list of line banks.  All of the lines in a bank belong to the
+    same chip and share the same line request configuration, so they can
+    be requested together.  If there is no bank with room for the line,
+    a new bank is created and appended to the list.
 
-    @param[in]
-        argC
-            number of arguments
-            (including the command itself)
+    The line's initial value in the bank is taken from the GPIO object
+    value, except for software PWM lines which start with 0.
 
-    @param[in]
-        argv
-            array of pointers to the command line arguments
+@param[in,out]
+    ppFirstBank
+        pointer to the location of the first line bank in the list
 
-    @param[in]
-        pState
-            pointer to the GPIOCtrl state object
+@param[in]
+    pGPIOChip
+        pointer to the GPIO chip which owns the line
 
-    @return none
+@param[in]
+    pGPIO
+        pointer to the GPIO line to add
 
-============================================================================*/
-static int ProcessOptions( int argC, char *argV[], GPIOCtrlState *pState )
+@retval EOK the GPIO line was added to a line bank
+@retval ENOMEM a new line bank could not be allocated
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddBankLine( LineBank **ppFirstBank,
+                        GPIOChip *pGPIOChip,
+                        GPIO *pGPIO )
 {
-    int c;
     int result = EINVAL;
-    const char *options = "hvf:";
+    LineBank *pBank;
+    LineBank *pLastBank = NULL;
+    int n;
 
-    if( ( pState != NULL ) &&
-        ( argV != NULL ) )
+    if ( ( ppFirstBank != NULL ) &&
+         ( pGPIOChip != NULL ) &&
+         ( pGPIO != NULL ) )
     {
-        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        /* look for a compatible bank with some room */
+        pBank = *ppFirstBank;
+        while ( pBank != NULL )
         {
-            switch( c )
+            if ( ( pBank->pGPIOChip == pGPIOChip ) &&
+                 ( pBank->request.request_type ==
+                        pGPIO->request.request_type ) &&
+                 ( pBank->request.flags == pGPIO->request.flags ) &&
+                 ( pBank->bulk.num_lines < GPIOD_LINE_BULK_MAX_LINES ) )
             {
-                case 'v':
-                    pState->verbose = true;
-                    break;
-
-                case 'h':
-                    usage( argV[0] );
-                    break;
+                break;
+            }
 
-                case 'f':
-                    pState->pFileName = strdup(optarg);
-                    break;
+            pLastBank = pBank;
+            pBank = pBank->pNext;
+        }
 
-                default:
-                    break;
+        if ( pBank == NULL )
+        {
+            /* create a new bank */
+            pBank = calloc( 1, sizeof( LineBank ) );
+            if ( pBank != NULL )
+            {
+                pBank->pGPIOChip = pGPIOChip;
+                pBank->request = pGPIO->request;
+                gpiod_line_bulk_init( &pBank->bulk );
 
+                if ( pLastBank == NULL )
+                {
+                    *ppFirstBank = pBank;
+                }
+                else
+                {
+                    pLastBank->pNext = pBank;
+                }
             }
         }
+
+        if ( pBank != NULL )
+        {
+            n = pBank->bulk.num_lines;
+            pBank->values[n] = ( pGPIO->PWM == true ) ? 0 : pGPIO->value;
+            pBank->pGPIOs[n] = pGPIO;
+            gpiod_line_bulk_add( &pBank->bulk, pGPIO->pLine );
+
+            pGPIO->pBank = pBank;
+            pGPIO->bankIndex = n;
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
     }
 
-    return 0;
+    return result;
 }
 
 /*============================================================================*/
-/*  SetupTerminationHandler                                                   */
+/*  RequestBanks                                                              */
 /*!
-    Set up an abnormal termination handler
+    Request the lines in a list of line banks
 
-    The SetupTerminationHandler function registers a termination handler
-    function with the kernel in case of an abnormal termination of this
-    process.
+    The RequestBanks function requests all of the lines in each line bank
+    with a single request per bank.  If a bank cannot be requested as a
+    whole, its lines are requested individually and the bank is marked
+    as not requested, so its lines will be written individually.
+    A line which cannot be requested individually either is logged and
+    marked as unusable, so it is never read or written.
+
+@param[in]
+    pFirstBank
+        pointer to the first line bank in the list
+
+@retval EOK all of the line banks were requested together
+@retval other error from the last line bank or line which could not be
+        requested
 
 ==============================================================================*/
-static void SetupTerminationHandler( void )
+static int RequestBanks( LineBank *pFirstBank )
 {
-    static struct sigaction sigact;
-
-    memset( &sigact, 0, sizeof(sigact) );
+    int result = EOK;
+    LineBank *pBank;
+    GPIO *pGPIO;
+    unsigned int i;
+    int rc;
 
-    sigact.sa_sigaction = TerminationHandler;
-    sigact.sa_flags = SA_SIGINFO;
+    pBank = pFirstBank;
+    while ( pBank != NULL )
+    {
+        rc = gpiod_line_request_bulk( &pBank->bulk,
+                                      &pBank->request,
+                                      pBank->values );
+        if ( rc == 0 )
+        {
+            pBank->requested = true;
+        }
+        else
+        {
+            result = errno;
+            syslog( LOG_ERR,
+                    "unable to request line bank on %s: %s",
+                    pBank->pGPIOChip->name,
+                    strerror( result ) );
+
+            /* fall back to requesting the lines individually */
+            pBank->requested = false;
+            for ( i = 0; i < pBank->bulk.num_lines; i++ )
+            {
+                pGPIO = pBank->pGPIOs[i];
+                rc = gpiod_line_request( pBank->bulk.lines[i],
+                                         &pBank->request,
+                                         pBank->values[i] );
+                if ( rc != 0 )
+                {
+                    result = errno;
+                    syslog( LOG_ERR,
+                            "unable to request line %d on %s: %s",
+                            pGPIO->line_num,
+                            pBank->pGPIOChip->name,
+                            strerror( result ) );
+
+                    /* the line is not read or written */
+                    pGPIO->unusable = true;
+                }
+            }
+        }
 
-    sigaction( SIGTERM, &sigact, NULL );
-    sigaction( SIGINT, &sigact, NULL );
+        pBank = pBank->pNext;
+    }
 
+    return result;
 }
 
 /*============================================================================*/
-/*  TerminationHandler                                                        */
+/*  WriteBanks                                                                */
 /*!
-    Abnormal termination handler
-
-    The TerminationHandler function will be invoked in case of an abnormal
-    termination of this process.  The termination handler closes
-    the connection with the variable server and cleans up its VARFP shared
-    memory.
+    Write the changed line values in a list of line banks
 
-@param[in]
-    signum
-        The signal which caused the abnormal termination (unused)
+    The WriteBanks function writes the line values of each line bank which
+    has changed since it was last written.  All of the lines in a bank are
+    written with a single request.
 
 @param[in]
-    info
-        pointer to a siginfo_t object (unused)
+    pFirstBank
+        pointer to the first line bank in the list
 
-@param[in]
-    ptr
-        signal context information (ucontext_t) (unused)
+@retval EOK the line banks were written
+@retval other error from the last line bank which could not be written
 
 ==============================================================================*/
-static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
+static int WriteBanks( LineBank *pFirstBank )
 {
-    syslog( LOG_ERR, "termination of gpioctrl\n" );
-    state.running = false;
+    int result = EOK;
+    LineBank *pBank;
+
+    pBank = pFirstBank;
+    while ( pBank != NULL )
+    {
+        if ( ( pBank->dirty == true ) &&
+             ( pBank->requested == true ) )
+        {
+            if ( gpiod_line_set_value_bulk( &pBank->bulk,
+                                            pBank->values ) != 0 )
+            {
+                result = errno;
+            }
+
+            pBank->dirty = false;
+        }
+
+        pBank = pBank->pNext;
+    }
+
+    return result;
 }
 
 /*============================================================================*/
-/*  UpdateOutput                                                              */
+/*  ReadBank                                                                  */
 /*!
-    Update a GPIO output
+    Read the line values of a line bank
 
-    The UpdateOutput function will be find the variable given by it's handle,
-    get the variable value, and write either a 1 (variable value is non-zero),
-    or a 0 (variable value is zero) to the GPIO line associated with the
-    variable handle.
+    The ReadBank function reads the values of all of the lines in a line
+    bank with a single request, and records the time they were read.
 
 @param[in]
-    hVar
-        Handle for the variable associated with the GPIO output
+    pBank
+        pointer to the line bank to read
 
 @param[in]
-    pState
-        pointer to a GPIOCtrlState object which contains the GPIO lines,
-        and a handle to the variable server
+    now
+        CLOCK_MONOTONIC time of the read in nanoseconds
 
-@retval EOK the GPIO line was updated correctly
-@retval ENOENT the variable was not found
-@retval ENOTSUP the variable type was invalid, or the GPIO is not an output
+@retval EOK the line bank was read
+@retval ENOTSUP the lines in the bank were not requested together
 @retval EINVAL invalid arguments
+@retval other error reading the line bank
 
 ==============================================================================*/
-static int UpdateOutput( VAR_HANDLE hVar, GPIOCtrlState *pState )
+static int ReadBank( LineBank *pBank, uint64_t now )
 {
     int result = EINVAL;
-    GPIO *pGPIO;
-    VarObject var;
-    int direction;
-    int rc;
 
-    if ( ( pState != NULL ) &&
-         ( hVar != VAR_INVALID ) )
+    if ( pBank != NULL )
     {
-        /* find the GPIO associated with the specified variable */
-        pGPIO = FindGPIO( pState, hVar );
-        if( pGPIO != NULL )
+        if ( pBank->requested == true )
         {
-            /* get the direction of this GPIO */
-            direction = pGPIO->direction;
-
-            /* confirm it is an output */
-            if ( direction == GPIOD_LINE_DIRECTION_OUTPUT )
+            if ( gpiod_line_get_value_bulk( &pBank->bulk,
+                                            pBank->values ) == 0 )
             {
-                /* get the requested output value */
-                if ( VAR_Get( pState->hVarServer,
-                              hVar,
-                              &var ) == EOK )
-                {
-                    if ( var.type == VARTYPE_UINT16 )
-                    {
-                        if( pGPIO->PWM == true )
-                        {
-                            pGPIO->value = ( var.val.ui <= 255  ) ? var.val.ui
-                                                                  : 255;
-                        }
-                        else
-                        {
-                            /* get the value to write to the output */
-                            pGPIO->value = ( var.val.ui > 0 ) ? 1 : 0;
-
-                            /* set the output value to the hardware */
-                            rc = gpiod_line_set_value( pGPIO->pLine,
-                                                       pGPIO->value );
-
-                            /* check the result */
-                            result = ( rc == EOK ) ? EOK : errno;
-                            if( result != EOK )
-                            {
-                                syslog( LOG_ERR, "UpdateOutput: %d %s",
-                                        result,
-                                        strerror(result) );
-                            }
-                            result = EOK;
-                        }
-                    }
-                    else
-                    {
-                        /* invalid data type */
-                        result = ENOTSUP;
-                    }
-                }
-                else
-                {
-                    /* unable to get the value */
-                    result = ENOENT;
-                }
+                pBank->readTime = now;
+                result = EOK;
             }
             else
             {
-                /* invalid line direction */
-                result = ENOTSUP;
+                result = errno;
             }
         }
         else
         {
-            /* variable not found */
-            result = ENOENT;
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FreeBanks                                                                 */
+/*!
+    Free a list of line banks
+
+    The FreeBanks function deallocates all of the line banks in the list.
+    The lines in the banks must be released separately.
+
+@param[in,out]
+    ppFirstBank
+        pointer to the location of the first line bank in the list
+
+==============================================================================*/
+static void FreeBanks( LineBank **ppFirstBank )
+{
+    LineBank *pBank;
+    LineBank *pTempBank;
+
+    if ( ppFirstBank != NULL )
+    {
+        pBank = *ppFirstBank;
+        while ( pBank != NULL )
+        {
+            pTempBank = pBank;
+            pBank = pBank->pNext;
+            free( pTempBank );
         }
+
+        *ppFirstBank = NULL;
     }
+}
+
+/*============================================================================*/
+/*  GetMonotonicTime                                                          */
+/*!
+    Get the current monotonic time
 
-    return result;
+    The GetMonotonicTime function gets the current CLOCK_MONOTONIC time
+    in nanoseconds.
+
+@return the current monotonic time in nanoseconds
+
+==============================================================================*/
+static uint64_t GetMonotonicTime( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( (uint64_t)ts.tv_sec * NS_PER_SEC ) + (uint64_t)ts.tv_nsec;
 }
 
 /*============================================================================*/
-/*  UpdateInput                                                               */
+/*  TimerInit                                                                 */
 /*!
-    Update a GPIO input
+    Initialize a timer
 
-    The UpdateInput function will be find the variable given by it's handle,
-    get the current state of the associated GPIO input and update the
-    variable value with the appropriate input value.
+    The TimerInit function initializes a timer which is not yet queued.
 
 @param[in]
-    hVar
-        Handle for the variable associated with the GPIO output
+    pTimer
+        pointer to the timer to initialize
 
 @param[in]
-    pState
-        pointer to a GPIOCtrlState object which contains the GPIO lines,
-        and a handle to the variable server
+    handler
+        pointer to the function to invoke when the timer expires
 
-@retval EOK the GPIO line was read correctly and the variable was updated
-@retval ENOENT the variable was not found
-@retval ENOTSUP the GPIO is not an input
-@retval EIO input error
+@param[in]
+    arg
+        opaque argument for the timer handler
+
+==============================================================================*/
+static void TimerInit( Timer *pTimer,
+                       void (*handler)( TimerQueue *pQueue,
+                                        Timer *pTimer,
+                                        uint64_t now ),
+                       void *arg )
+{
+    if ( pTimer != NULL )
+    {
+        pTimer->due = 0;
+        pTimer->index = TIMER_IDLE;
+        pTimer->handler = handler;
+        pTimer->arg = arg;
+        pTimer->pNextExpired = NULL;
+    }
+}
+
+/*============================================================================*/
+/*  TimerStart                                                                */
+/*!
+    Start a timer
+
+    The TimerStart function schedules the timer to expire at the specified
+    absolute time.  If the timer is already queued, it is moved to its new
+    position in the queue rather than being queued a second time.  If the
+    timer has expired but its handler has not yet been invoked, the pending
+    expiry is cancelled and the timer is queued again.  The queue is grown
+    as required.
+
+@param[in]
+    pQueue
+        pointer to the timer queue
+
+@param[in]
+    pTimer
+        pointer to the timer to start
+
+@param[in]
+    due
+        absolute CLOCK_MONOTONIC expiry time in nanoseconds
+
+@retval EOK the timer was started
+@retval ENOMEM the timer queue could not be grown
 @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int UpdateInput( VAR_HANDLE hVar, GPIOCtrlState *pState )
+static int TimerStart( TimerQueue *pQueue, Timer *pTimer, uint64_t due )
 {
     int result = EINVAL;
-    GPIO *pGPIO;
-    VarObject var;
-    int direction;
-    int rc;
+    Timer **pTimers;
+    size_t size;
 
-    if ( ( pState != NULL ) &&
-         ( hVar != VAR_INVALID ) )
+    if ( ( pQueue != NULL ) &&
+         ( pTimer != NULL ) )
     {
-        /* find the GPIO associated with the specified variable */
-        pGPIO = FindGPIO( pState, hVar );
-        if( pGPIO != NULL )
-        {
-            /* get the direction of this GPIO */
-            direction = pGPIO->direction;
+        result = EOK;
 
-            /* confirm it is an output */
-            if ( direction == GPIOD_LINE_DIRECTION_INPUT )
+        if ( pTimer->index < 0 )
+        {
+            if ( pQueue->n == pQueue->size )
             {
-                /* read the GPIO line */
-                rc = gpiod_line_get_value( pGPIO->pLine );
-                if ( rc != -1 )
+                /* grow the timer queue */
+                size = ( pQueue->size == 0 ) ? 16 : pQueue->size * 2;
+                pTimers = realloc( pQueue->pTimers, size * sizeof( Timer * ) );
+                if ( pTimers != NULL )
                 {
-                    /* set the value of the variable */
-                    var.val.ui = ( rc > 0 ) ? 1 : 0;
-                    var.type = VARTYPE_UINT16;
-                    var.len = sizeof(uint16_t);
-
-                    /* write to the variable */
-                    result = VAR_Set( pState->hVarServer,
-                                      hVar,
-                                      &var );
+                    pQueue->pTimers = pTimers;
+                    pQueue->size = size;
                 }
                 else
                 {
-                    /* input error when reading from the GPIO line */
-                    result = EIO;
+                    result = ENOMEM;
                 }
             }
-            else
+
+            if ( result == EOK )
             {
-                /* unsupported action on this GPIO line */
-                result = ENOTSUP;
+                /* append the timer to the queue */
+                pTimer->due = due;
+                pTimer->index = (int)pQueue->n;
+                pQueue->pTimers[pQueue->n++] = pTimer;
+                TimerSiftUp( pQueue, pTimer->index );
             }
         }
         else
         {
-            /* variable not found */
-            result = ENOENT;
+            /* move the timer to its new position */
+            pTimer->due = due;
+            TimerSiftUp( pQueue, pTimer->index );
+            TimerSiftDown( pQueue, pTimer->index );
         }
     }
 
@@ -2066,289 +9928,289 @@ static int UpdateInput( VAR_HANDLE hVar, GPIOCtrlState *pState )
 }
 
 /*============================================================================*/
-/*  PrintStatus                                                               */
+/*  TimerStop                                                                 */
 /*!
-    Print the GPIO controller status
+    Stop a timer
 
-    The PrintStatus function iterates through the GPIO lines and
-    outputs a JSON object which lists the GPIO lines.
+    The TimerStop function removes the timer from the timer queue.
+    Stopping an expired timer whose handler has not yet been invoked
+    cancels the pending expiry.  Stopping a timer which is not queued has
+    no effect.
 
 @param[in]
-    pState
-        pointer to the GPIO controller state
+    pQueue
+        pointer to the timer queue
 
 @param[in]
-    fd
-        output file descriptor
-
-@retval EOK the GPIO status was printed
-@retval EINVAL invalid arguments
+    pTimer
+        pointer to the timer to stop
 
 ==============================================================================*/
-static int PrintStatus( GPIOCtrlState *pState, int fd )
+static void TimerStop( TimerQueue *pQueue, Timer *pTimer )
 {
-    GPIOChip *pGPIOChip;
-    GPIO *pGPIO;
-    int result = EINVAL;
+    size_t i;
 
-    if ( ( pState != NULL ) &&
-         ( fd != -1 ) )
+    if ( ( pQueue != NULL ) &&
+         ( pTimer != NULL ) &&
+         ( pTimer->index >= 0 ) )
     {
-        (void)write( fd, "[", 1 );
+        i = (size_t)pTimer->index;
 
-        /* start looking in the first GPIO chip */
-        pGPIOChip = pState->pFirstGPIOChip;
-        while ( pGPIOChip != NULL )
+        /* move the last timer into the vacated slot */
+        pQueue->n--;
+        if ( i != pQueue->n )
         {
-            if( pGPIOChip != pState->pFirstGPIOChip )
-            {
-                (void)write( fd, ",", 1 );
-            }
-
-            dprintf(fd, "{ \"chip\" : \"%s\", \"lines\" : [", pGPIOChip->name);
+            pQueue->pTimers[i] = pQueue->pTimers[pQueue->n];
+            pQueue->pTimers[i]->index = (int)i;
+            TimerSiftUp( pQueue, i );
+            TimerSiftDown( pQueue, i );
+        }
 
-            /* start looking in the first line of the chip */
-            pGPIO = pGPIOChip->pFirstLine;
-            while ( pGPIO != NULL )
-            {
-                if( pGPIO != pGPIOChip->pFirstLine )
-                {
-                    (void)write( fd, ",", 1 );
-                }
+        pTimer->index = TIMER_IDLE;
+    }
+    else if ( ( pTimer != NULL ) &&
+              ( pTimer->index == TIMER_EXPIRED ) )
+    {
+        /* cancel the pending expiry */
+        pTimer->index = TIMER_IDLE;
+    }
+}
 
-                /* print the line information */
-                PrintLineInfo( pState, pGPIO, fd );
+/*============================================================================*/
+/*  TimerNext                                                                 */
+/*!
+    Get the next timer to expire
 
-                /* move on to the next GPIO line */
-                pGPIO = pGPIO->pNext;
-            }
+    The TimerNext function gets the timer with the earliest expiry time
+    without removing it from the queue.
 
-            /* close the chip */
-            (void)write( fd, "]}", 2 );
+@param[in]
+    pQueue
+        pointer to the timer queue
 
-            /* move to the next GPIO chip */
-            pGPIOChip = pGPIOChip->pNext;
-        }
+@retval pointer to the next timer to expire
+@retval NULL if the queue is empty
 
-        (void)write( fd, "]", 1 );
+==============================================================================*/
+static Timer *TimerNext( TimerQueue *pQueue )
+{
+    Timer *pTimer = NULL;
 
-        result = EOK;
+    if ( ( pQueue != NULL ) &&
+         ( pQueue->n > 0 ) )
+    {
+        pTimer = pQueue->pTimers[0];
     }
 
-    return result;
+    return pTimer;
 }
 
 /*============================================================================*/
-/*  PrintLineInfo                                                             */
+/*  TimerExpire                                                               */
 /*!
-    Print the GPIO line information
-
-    The PrintLineInfo function prints a JSON object containing the
-    GPIO line information
+    Remove the expired timers from a timer queue
 
-@param[in]
-    pState
-        pointer to the GPIO controller state
+    The TimerExpire function removes all of the timers which expire at or
+    before the specified time from the timer queue, and returns them as
+    a list linked through their pNextExpired pointers, in expiry order.
+    The listed timers are marked TIMER_EXPIRED until their handlers are
+    invoked.
 
 @param[in]
-    pGPIO
-        pointer to the GPIO object to print
+    pQueue
+        pointer to the timer queue
 
 @param[in]
-    fd
-        output file descriptor
+    limit
+        absolute CLOCK_MONOTONIC time in nanoseconds
 
-@retval EOK the GPIO line information was printed
-@retval EINVAL invalid arguments
+@retval pointer to the first expired timer
+@retval NULL if no timers have expired
 
 ==============================================================================*/
-static int PrintLineInfo( GPIOCtrlState *pState, GPIO *pGPIO, int fd )
+static Timer *TimerExpire( TimerQueue *pQueue, uint64_t limit )
 {
-    GPIOChip *pGPIOChip;
-    int result = EINVAL;
-    const char *line_name;
+    Timer *pFirst = NULL;
+    Timer *pLast = NULL;
+    Timer *pTimer;
 
-    if ( ( pState != NULL ) &&
-         ( pGPIO != NULL ) &&
-         ( fd != -1 ) )
+    pTimer = TimerNext( pQueue );
+    while ( ( pTimer != NULL ) &&
+            ( pTimer->due <= limit ) )
     {
-        if ( pGPIO->pLine != NULL )
-        {
-            /* get the line name */
-            line_name = gpiod_line_name( pGPIO->pLine );
+        TimerStop( pQueue, pTimer );
+        pTimer->index = TIMER_EXPIRED;
+        pTimer->pNextExpired = NULL;
 
-            dprintf( fd,
-                     "{ \"line\" : %d, "
-                     "\"name\" : \"%s\", "
-                     "\"var\" : \"%s\"}",
-                     pGPIO->line_num,
-                     ( line_name != NULL ) ? line_name : "unknown",
-                     pGPIO->name);
+        if ( pLast == NULL )
+        {
+            pFirst = pTimer;
+        }
+        else
+        {
+            pLast->pNextExpired = pTimer;
         }
 
-        result = EOK;
+        pLast = pTimer;
+        pTimer = TimerNext( pQueue );
     }
 
-    return result;
+    return pFirst;
 }
 
 /*============================================================================*/
-/* Shutdown                                                                   */
+/*  TimerDispatch                                                             */
 /*!
-    Shutdown the GPIO control service
+    Process the expired timers in a timer queue
 
-    The Shutdown service iterates through all of the GPIO resources
-    and closes and deallocates them.
+    The TimerDispatch function removes all of the timers which expire at
+    or before the specified limit from the timer queue, and invokes their
+    handlers in expiry order.  Timers which are restarted by the handlers
+    are processed on the next dispatch.  A handler which starts or stops
+    another expired timer cancels its pending expiry, so that timer's
+    handler is not invoked in this dispatch.
 
 @param[in]
-    pState
-        pointer to the GPIO controller state
+    pQueue
+        pointer to the timer queue
+
+@param[in]
+    now
+        current CLOCK_MONOTONIC time in nanoseconds
+
+@param[in]
+    limit
+        absolute CLOCK_MONOTONIC time in nanoseconds
 
 ==============================================================================*/
-static void Shutdown( GPIOCtrlState *pState )
+static void TimerDispatch( TimerQueue *pQueue, uint64_t now, uint64_t limit )
 {
-    GPIOChip *pGPIOChip;
-    GPIOChip *pTempGPIOChip;
-    GPIO *pGPIO;
-    GPIO *pTempGPIO;
+    Timer *pTimer;
+    Timer *pNext;
 
-    if ( pState != NULL )
+    pTimer = TimerExpire( pQueue, limit );
+    while ( pTimer != NULL )
     {
-        /* start looking in the first GPIO chip */
-        pGPIOChip = pState->pFirstGPIOChip;
-        while ( pGPIOChip != NULL )
-        {
-            /* start looking in the first line of the chip */
-            pGPIO = pGPIOChip->pFirstLine;
-            while ( pGPIO != NULL )
-            {
-                pTempGPIO = pGPIO;
-
-                /* move on to the next GPIO line */
-                pGPIO = pGPIO->pNext;
-
-                if ( pTempGPIO->pLine != NULL )
-                {
-                    gpiod_line_release( pTempGPIO->pLine );
-                }
-
-                /* free the GPIO line object */
-                free( pTempGPIO );
-            }
-
-            pTempGPIOChip = pGPIOChip;
-
-            if( pTempGPIOChip->pChip != NULL )
-            {
-                gpiod_chip_close( pTempGPIOChip->pChip );
-            }
+        pNext = pTimer->pNextExpired;
+        pTimer->pNextExpired = NULL;
 
-            /* move to the next GPIO chip */
-            pGPIOChip = pGPIOChip->pNext;
+        if ( pTimer->index == TIMER_EXPIRED )
+        {
+            pTimer->index = TIMER_IDLE;
+            pTimer->handler( pQueue, pTimer, now );
         }
-    }
 
-    pState->pFirstGPIOChip = NULL;
-    pState->pLastGPIOChip = NULL;
+        pTimer = pNext;
+    }
 }
 
 /*============================================================================*/
-/*  CreatePWM                                                                 */
+/*  TimerSiftUp                                                               */
 /*!
-    Create an output PWM thread
+    Move a timer towards the front of the timer queue
 
-    The CreatePWM thread creates a thread for controlling a software PWM
-    pin.  This is highly inefficient and not recommended for a large
-    number of GPIO pins, but may be used in a pinch if you have CPU
-    cycles to burn.
+    The TimerSiftUp function moves the timer at the specified position
+    towards the front of the queue until it does not expire before
+    its parent.
 
 @param[in]
-    pGPIO
-        pointer to the GPIO pin to create a PWM thread for
+    pQueue
+        pointer to the timer queue
+
+@param[in]
+    i
+        position of the timer to move
 
 ==============================================================================*/
-static int CreatePWM( GPIO *pGPIO )
+static void TimerSiftUp( TimerQueue *pQueue, size_t i )
 {
-    int result = EINVAL;
-    pthread_attr_t attr;
-    pthread_t thread;
+    size_t parent;
 
-    if( pGPIO != NULL )
+    while ( i > 0 )
     {
-        result = pthread_attr_init( &attr );
+        parent = ( i - 1 ) / 2;
+        if ( pQueue->pTimers[i]->due >= pQueue->pTimers[parent]->due )
+        {
+            break;
+        }
 
-        result = pthread_create( &thread, NULL, PWMThread, (void *)pGPIO );
-        pthread_attr_destroy( &attr );
+        TimerSwap( pQueue, i, parent );
+        i = parent;
     }
 }
 
 /*============================================================================*/
-/*  PWM Thread                                                                */
+/*  TimerSiftDown                                                             */
 /*!
-    PWM Thread
+    Move a timer towards the back of the timer queue
 
-    The PWM thread is associated with a single GPIO pin.  It toggles
-    the GPIO pin on and off with ~ 100Hz frequency.  The value assigned
-    to the PWM pin controls the duty cycle within the range [0.255]
-    For example, setting the pin's value to 128 will set ~50% duty
-    cycle.
+    The TimerSiftDown function moves the timer at the specified position
+    towards the back of the queue until it does not expire after
+    either of its children.
 
 @param[in]
-    pGPIO
-        pointer to the GPIO pin to control as a PWM output
+    pQueue
+        pointer to the timer queue
+
+@param[in]
+    i
+        position of the timer to move
 
 ==============================================================================*/
-static void *PWMThread( void *arg )
+static void TimerSiftDown( TimerQueue *pQueue, size_t i )
 {
-    GPIO *pGPIO = (GPIO *)arg;
-    int t;
-    sigset_t mask;
-
-    /* block real time signals on this thread */
-    sigemptyset( &mask );
-    sigaddset( &mask, SIG_VAR_MODIFIED );
-    sigaddset( &mask, SIG_VAR_CALC );
-    sigaddset( &mask, SIG_VAR_PRINT );
-    sigaddset( &mask, SIG_VAR_VALIDATE );
-    sigprocmask( SIG_BLOCK, &mask, NULL );
+    size_t child;
 
-    if( pGPIO != NULL )
+    while ( ( child = ( 2 * i ) + 1 ) < pQueue->n )
     {
-        /* repeat forever */
-        while ( 1 )
+        if ( ( child + 1 < pQueue->n ) &&
+             ( pQueue->pTimers[child + 1]->due <
+               pQueue->pTimers[child]->due ) )
         {
+            child++;
+        }
 
-            /* limit the value to [0.255] */
-            if ( pGPIO->value < 0 )
-            {
-                pGPIO->value = 0;
-            }
+        if ( pQueue->pTimers[i]->due <= pQueue->pTimers[child]->due )
+        {
+            break;
+        }
 
-            if ( pGPIO->value > 255 )
-            {
-                pGPIO->value = 255;
-            }
+        TimerSwap( pQueue, i, child );
+        i = child;
+    }
+}
 
-            /* sleep until it is tim to turn the output off */
-            t = ( pGPIO->value * 40 );
-            if ( t > 0 )
-            {
-                /* set the output value to the hardware */
-                gpiod_line_set_value( pGPIO->pLine, 1 );
-                usleep( t );
-            }
+/*============================================================================*/
+/*  TimerSwap                                                                 */
+/*!
+    Swap two timers in the timer queue
 
+    The TimerSwap function exchanges the timers at the specified positions
+    in the timer queue and updates their stored positions.
 
-            /* sleep until it is time to turn the output on */
-            t = ( ( 255 - pGPIO->value ) * 40 );
-            if ( t > 0 )
-            {
-                /* set the output value to the hardware */
-                gpiod_line_set_value( pGPIO->pLine, 0 );
-                usleep ( t );
-            }
-        }
-    }
+@param[in]
+    pQueue
+        pointer to the timer queue
+
+@param[in]
+    i
+        position of the first timer
+
+@param[in]
+    j
+        position of the second timer
+
+==============================================================================*/
+static void TimerSwap( TimerQueue *pQueue, size_t i, size_t j )
+{
+    Timer *pTimer;
+
+    pTimer = pQueue->pTimers[i];
+    pQueue->pTimers[i] = pQueue->pTimers[j];
+    pQueue->pTimers[j] = pTimer;
+
+    pQueue->pTimers[i]->index = (int)i;
+    pQueue->pTimers[j]->index = (int)j;
 }
 
 /*! @}
@@ -0,0 +1,343 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup bench_bulk_read bench_bulk_read
+ * @brief Single and bulk polled input read benchmark
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file bench_bulk_read.c
+
+    Single and bulk polled input read benchmark
+
+    The bench_bulk_read application measures the cost of taking a
+    snapshot of 64 input lines of a GPIO chip, once by reading each
+    line with ReadLineLevel as a polled input on its own is read, and
+    once by reading a line bank with ReadBank as polled inputs which
+    share a bank are read.  The snapshots taken both ways are compared,
+    and the benchmark fails if they differ.
+
+    The benchmark is intended to be run against a gpio-sim chip by the
+    gpiosim_bulk_read.sh script, but any chip with at least 64 unused
+    lines may be named on the command line.  Without a chip name it
+    exits with the ctest skip code.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+/* the benchmark calls the private functions of the gpioctrl service */
+#define main gpioctrl_main
+#include "../src/gpioctrl.c"
+#undef main
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of input lines in a snapshot */
+#define BENCH_LINES             ( 64 )
+
+/*! default number of snapshots timed for each read method */
+#define BENCH_SNAPSHOTS         ( 10000 )
+
+/*! exit code used to tell ctest the benchmark was skipped */
+#define BENCH_SKIP              ( 77 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! GPIO controller state used by the benchmark */
+static GPIOCtrlState benchState;
+
+/*! GPIO chip under test */
+static GPIOChip benchChip;
+
+/*! input lines under test */
+static GPIO benchLines[BENCH_LINES];
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ReadSingle( int snapshots, int *pLevels );
+static int ReadBulk( int snapshots, int *pLevels );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the single and bulk read benchmark
+
+    The main function opens the named GPIO chip, sets up the first
+    BENCH_LINES lines as polled inputs, and times the single and bulk
+    read methods.
+
+    @param[in]
+        argc
+            number of arguments on the command line
+
+    @param[in]
+        argv
+            argv[1] names the GPIO chip, and argv[2] optionally gives
+            the number of snapshots to time
+
+    @retval 0 the benchmark completed and the snapshots matched
+    @retval 1 the lines could not be read, or the snapshots differed
+    @retval 77 no usable GPIO chip was given
+
+==============================================================================*/
+int main( int argc, char **argv )
+{
+    char path[BUFSIZ];
+    int single[BENCH_LINES];
+    int bulk[BENCH_LINES];
+    int snapshots = BENCH_SNAPSHOTS;
+    int result = 1;
+    int i;
+
+    if ( argc < 2 )
+    {
+        printf( "SKIP: usage: %s <gpiochip> [snapshots]\n", argv[0] );
+        return BENCH_SKIP;
+    }
+
+    if ( argc > 2 )
+    {
+        snapshots = atoi( argv[2] );
+    }
+
+    benchState.service = "bench_bulk_read";
+    benchChip.name = argv[1];
+    snprintf( path, sizeof( path ), "/dev/%s", argv[1] );
+    benchChip.pChip = gpiod_chip_open( path );
+    if ( benchChip.pChip == NULL )
+    {
+        printf( "SKIP: cannot open %s: %s\n", argv[1], strerror( errno ) );
+        return BENCH_SKIP;
+    }
+
+    if ( gpiod_chip_num_lines( benchChip.pChip ) < BENCH_LINES )
+    {
+        printf( "SKIP: %s has fewer than %d lines\n", argv[1], BENCH_LINES );
+        gpiod_chip_close( benchChip.pChip );
+        return BENCH_SKIP;
+    }
+
+    for ( i = 0; i < BENCH_LINES; i++ )
+    {
+        benchLines[i].line_num = i;
+        benchLines[i].lineFd = -1;
+        benchLines[i].pLine = gpiod_chip_get_line( benchChip.pChip, i );
+        benchLines[i].request.consumer = benchState.service;
+        benchLines[i].request.request_type =
+                                    GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+    }
+
+    printf( "%s: %d lines, %d snapshots\n", argv[1], BENCH_LINES, snapshots );
+    printf( "%8s %14s %12s\n", "method", "ns/snapshot", "ns/line" );
+
+    if ( ( ReadSingle( snapshots, single ) == EOK ) &&
+         ( ReadBulk( snapshots, bulk ) == EOK ) )
+    {
+        if ( memcmp( single, bulk, sizeof( single ) ) == 0 )
+        {
+            result = 0;
+        }
+        else
+        {
+            printf( "FAIL: the single and bulk snapshots differ\n" );
+        }
+    }
+
+    gpiod_chip_close( benchChip.pChip );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadSingle                                                                */
+/*!
+    Time snapshots taken one line at a time
+
+    The ReadSingle function requests each line on its own, and times
+    snapshots taken by reading every line with ReadLineLevel, which
+    costs one system call per line.
+
+    @param[in]
+        snapshots
+            number of snapshots to time
+
+    @param[out]
+        pLevels
+            array to receive the levels of the last snapshot
+
+    @retval EOK the snapshots were taken
+    @retval EIO a line could not be requested or read
+
+==============================================================================*/
+static int ReadSingle( int snapshots, int *pLevels )
+{
+    int result = EOK;
+    uint64_t start;
+    uint64_t end;
+    int n;
+    int i;
+
+    for ( i = 0; i < BENCH_LINES; i++ )
+    {
+        if ( gpiod_line_request( benchLines[i].pLine,
+                                 &benchLines[i].request,
+                                 0 ) != 0 )
+        {
+            printf( "FAIL: cannot request line %d: %s\n",
+                    i,
+                    strerror( errno ) );
+            result = EIO;
+        }
+    }
+
+    start = GetMonotonicTime();
+
+    for ( n = 0; ( n < snapshots ) && ( result == EOK ); n++ )
+    {
+        for ( i = 0; i < BENCH_LINES; i++ )
+        {
+            pLevels[i] = ReadLineLevel( &benchLines[i] );
+            if ( pLevels[i] < 0 )
+            {
+                result = EIO;
+            }
+        }
+    }
+
+    end = GetMonotonicTime();
+
+    if ( ( result == EOK ) && ( snapshots > 0 ) )
+    {
+        printf( "%8s %14.1f %12.1f\n",
+                "single",
+                (double)( end - start ) / snapshots,
+                (double)( end - start ) / snapshots / BENCH_LINES );
+    }
+
+    for ( i = 0; i < BENCH_LINES; i++ )
+    {
+        gpiod_line_release( benchLines[i].pLine );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadBulk                                                                  */
+/*!
+    Time snapshots taken with one bulk read
+
+    The ReadBulk function adds the lines to a line bank and requests the
+    bank, as gpioctrl does for polled inputs on the same chip, and times
+    snapshots taken with ReadBank, which costs one system call for all
+    of the lines.
+
+    @param[in]
+        snapshots
+            number of snapshots to time
+
+    @param[out]
+        pLevels
+            array to receive the levels of the last snapshot
+
+    @retval EOK the snapshots were taken
+    @retval EIO the bank could not be requested or read
+
+==============================================================================*/
+static int ReadBulk( int snapshots, int *pLevels )
+{
+    LineBank *pFirstBank = NULL;
+    int result = EOK;
+    uint64_t start;
+    uint64_t end;
+    int n;
+    int i;
+
+    for ( i = 0; i < BENCH_LINES; i++ )
+    {
+        if ( AddBankLine( &pFirstBank, &benchChip, &benchLines[i] ) != EOK )
+        {
+            result = EIO;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( ( RequestBanks( pFirstBank ) != EOK ) ||
+           ( pFirstBank->pNext != NULL ) ) )
+    {
+        printf( "FAIL: cannot request the lines as one bank\n" );
+        result = EIO;
+    }
+
+    start = GetMonotonicTime();
+
+    for ( n = 0; ( n < snapshots ) && ( result == EOK ); n++ )
+    {
+        result = ReadBank( pFirstBank, start );
+    }
+
+    end = GetMonotonicTime();
+
+    if ( ( result == EOK ) && ( snapshots > 0 ) )
+    {
+        memcpy( pLevels, pFirstBank->values, BENCH_LINES * sizeof( int ) );
+        printf( "%8s %14.1f %12.1f\n",
+                "bulk",
+                (double)( end - start ) / snapshots,
+                (double)( end - start ) / snapshots / BENCH_LINES );
+    }
+    else if ( result != EOK )
+    {
+        result = EIO;
+    }
+
+    if ( pFirstBank != NULL )
+    {
+        gpiod_line_release_bulk( &pFirstBank->bulk );
+    }
+
+    FreeBanks( &pFirstBank );
+
+    return result;
+}
+
+/*! @}
+ * end of bench_bulk_read group */
@@ -0,0 +1,556 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup bench_debounce bench_debounce
+ * @brief Debounce filter replay benchmark
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file bench_debounce.c
+
+    Debounce filter replay benchmark
+
+    The bench_debounce application replays traces of switch input edges
+    through the gpioctrl event handling, once with every edge published
+    and once for each of a range of userspace debounce intervals, and
+    reports the number of variable updates and the cost of handling an
+    edge.  No GPIO hardware or variable server is required.
+
+    By default synthetic traces are generated: a switch which is pressed
+    and released every 50 ms, with a burst of 2 to 12 bounces between
+    20 and 300 microseconds apart after every edge.  The trace is
+    replayed for a line watching both edges which starts low, for one
+    which starts high, and for a line watching only rising edges.  Once
+    the debounce interval is longer than the longest gap between the
+    edges the line reads during a burst, each of these must publish
+    exactly one update per burst, and the benchmark fails if it does not.
+    The bounces of a release include rising edges, so the rising edge
+    line publishes at every press and at every release.
+
+    A recorded trace can be replayed instead by naming a file which
+    contains one edge per line, as a CLOCK_MONOTONIC timestamp in
+    nanoseconds followed by the level of the line after the edge, for
+    example:
+
+        1523467112345 1
+        1523467160210 0
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+/* the benchmark calls the private functions of the gpioctrl service */
+#define main gpioctrl_main
+#include "../src/gpioctrl.c"
+#undef main
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of presses in the synthetic trace */
+#define BENCH_PRESSES           ( 1000 )
+
+/*! interval between the edges of the synthetic trace in nanoseconds */
+#define BENCH_EDGE_INTERVAL     ( 25 * NS_PER_MS )
+
+/*! longest gap between the bounces of the synthetic trace in nanoseconds */
+#define BENCH_MAX_BOUNCE_GAP    ( 300 * NS_PER_US )
+
+/*! maximum number of edges in a trace */
+#define BENCH_MAX_EDGES         ( 1000000 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! GPIO controller state used by the benchmark */
+static GPIOCtrlState benchState;
+
+/*! edges of the trace being replayed */
+static LineEvent trace[BENCH_MAX_EDGES];
+
+/*! debounce intervals in microseconds which each trace is replayed with */
+static const uint64_t intervals_us[] = { 0, 100, 500, 1000, 5000 };
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static size_t CreateSyntheticTrace( LineEvent *pEvents,
+                                    size_t max,
+                                    uint16_t initial );
+static size_t SelectEdges( LineEvent *pEvents, size_t n, uint16_t level );
+static size_t ReadTrace( const char *filename,
+                         LineEvent *pEvents,
+                         size_t max );
+static int ReplayTrace( const char *name,
+                        LineEvent *pEvents,
+                        size_t n,
+                        int event_type,
+                        uint16_t initial,
+                        uint64_t expected,
+                        uint64_t gap );
+static uint64_t Replay( LineEvent *pEvents,
+                        size_t n,
+                        uint64_t interval,
+                        int event_type,
+                        uint16_t initial );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the debounce filter replay benchmark
+
+    The main function loads or generates the traces, and replays them
+    without the debounce filter and with debounce intervals of 100
+    microseconds to 5 milliseconds.
+
+    @param[in]
+        argc
+            number of arguments on the command line
+
+    @param[in]
+        argv
+            argv[1] optionally names a recorded trace file
+
+    @retval 0 the benchmark completed
+    @retval 1 the trace could not be loaded, or a synthetic trace did not
+              publish one update per burst of edges
+
+==============================================================================*/
+int main( int argc, char **argv )
+{
+    size_t n;
+    int result = 0;
+
+    if ( argc > 1 )
+    {
+        n = ReadTrace( argv[1], trace, BENCH_MAX_EDGES );
+        if ( n > 0 )
+        {
+            /* the line was at the other level before the first edge */
+            result = ReplayTrace( argv[1],
+                                  trace,
+                                  n,
+                                  GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES,
+                                  !trace[0].level,
+                                  0,
+                                  0 );
+        }
+        else
+        {
+            fprintf( stderr, "no edges to replay\n" );
+            result = 1;
+        }
+    }
+    else
+    {
+        n = CreateSyntheticTrace( trace, BENCH_MAX_EDGES, 0 );
+        result |= ReplayTrace( "both edges, starting low",
+                               trace,
+                               n,
+                               GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES,
+                               0,
+                               2 * BENCH_PRESSES,
+                               BENCH_MAX_BOUNCE_GAP );
+
+        n = CreateSyntheticTrace( trace, BENCH_MAX_EDGES, 1 );
+        result |= ReplayTrace( "both edges, starting high",
+                               trace,
+                               n,
+                               GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES,
+                               1,
+                               2 * BENCH_PRESSES,
+                               BENCH_MAX_BOUNCE_GAP );
+
+        /* a rising edge line is only told about the rising edges, which
+         * are up to two bounce gaps apart */
+        n = CreateSyntheticTrace( trace, BENCH_MAX_EDGES, 0 );
+        n = SelectEdges( trace, n, 1 );
+        result |= ReplayTrace( "rising edge only",
+                               trace,
+                               n,
+                               GPIOD_LINE_REQUEST_EVENT_RISING_EDGE,
+                               0,
+                               2 * BENCH_PRESSES,
+                               2 * BENCH_MAX_BOUNCE_GAP );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CreateSyntheticTrace                                                      */
+/*!
+    Generate a synthetic bouncing switch trace
+
+    The CreateSyntheticTrace function generates BENCH_PRESSES presses
+    and releases of a switch, BENCH_EDGE_INTERVAL apart.  Each edge is
+    followed by a pseudo-random burst of 2 to 12 bounces, 20 to 300
+    microseconds apart, which ends at the level of the edge.
+
+    @param[out]
+        pEvents
+            array to receive the trace
+
+    @param[in]
+        max
+            maximum number of edges in the trace
+
+    @param[in]
+        initial
+            level of the switch before the first edge
+
+    @retval number of edges in the trace
+
+==============================================================================*/
+static size_t CreateSyntheticTrace( LineEvent *pEvents,
+                                    size_t max,
+                                    uint16_t initial )
+{
+    uint32_t seed = 1;
+    uint64_t t = NS_PER_SEC;
+    uint16_t level = initial;
+    size_t n = 0;
+    int bounces;
+    int edge;
+    int i;
+
+    for ( edge = 0; edge < 2 * BENCH_PRESSES; edge++ )
+    {
+        level = !level;
+
+        /* linear congruential generator for the bounce bursts */
+        seed = seed * 1103515245u + 12345u;
+        bounces = 2 * ( 1 + ( ( seed >> 8 ) % 6 ) );
+
+        /* the edge, then pairs of bounces away and back */
+        for ( i = 0; ( i <= bounces ) && ( n < max ); i++ )
+        {
+            seed = seed * 1103515245u + 12345u;
+            pEvents[n].timestamp = t;
+            pEvents[n].level = ( ( i & 1 ) == 0 ) ? level : !level;
+            t += ( 20 + ( ( seed >> 8 ) % 281 ) ) * NS_PER_US;
+            n++;
+        }
+
+        t = NS_PER_SEC + ( edge + 1 ) * BENCH_EDGE_INTERVAL;
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  SelectEdges                                                               */
+/*!
+    Keep the edges of a trace which end at one level
+
+    The SelectEdges function removes the edges of a trace which do not
+    end at the specified level, leaving the events which a line watching
+    only rising (level 1) or falling (level 0) edges would read.
+
+    @param[in,out]
+        pEvents
+            trace to filter in place
+
+    @param[in]
+        n
+            number of edges in the trace
+
+    @param[in]
+        level
+            level of the edges to keep
+
+    @retval number of edges left in the trace
+
+==============================================================================*/
+static size_t SelectEdges( LineEvent *pEvents, size_t n, uint16_t level )
+{
+    size_t count = 0;
+    size_t i;
+
+    for ( i = 0; i < n; i++ )
+    {
+        if ( pEvents[i].level == level )
+        {
+            pEvents[count++] = pEvents[i];
+        }
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  ReadTrace                                                                 */
+/*!
+    Read a recorded trace
+
+    The ReadTrace function reads a trace file containing one edge per
+    line, as a timestamp in nanoseconds followed by the level of the line.
+    Lines which cannot be parsed are skipped.
+
+    @param[in]
+        filename
+            name of the trace file
+
+    @param[out]
+        pEvents
+            array to receive the trace
+
+    @param[in]
+        max
+            maximum number of edges in the trace
+
+    @retval number of edges read from the trace
+
+==============================================================================*/
+static size_t ReadTrace( const char *filename,
+                         LineEvent *pEvents,
+                         size_t max )
+{
+    char buf[BUFSIZ];
+    unsigned long long timestamp;
+    unsigned int level;
+    size_t n = 0;
+    FILE *fp;
+
+    fp = fopen( filename, "r" );
+    if ( fp != NULL )
+    {
+        while ( ( n < max ) && ( fgets( buf, sizeof( buf ), fp ) != NULL ) )
+        {
+            if ( sscanf( buf, "%llu %u", &timestamp, &level ) == 2 )
+            {
+                pEvents[n].timestamp = timestamp;
+                pEvents[n].level = ( level != 0 ) ? 1 : 0;
+                n++;
+            }
+        }
+
+        fclose( fp );
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  ReplayTrace                                                               */
+/*!
+    Replay a trace with each debounce interval
+
+    The ReplayTrace function prints a heading for the trace, and replays
+    it without the filter and with each of the debounce intervals.  The
+    updates published with the intervals which are longer than the gap
+    between the edges of a burst are checked against the number of
+    bursts in the trace.
+
+    @param[in]
+        name
+            name of the trace to print
+
+    @param[in]
+        pEvents
+            edges of the trace
+
+    @param[in]
+        n
+            number of edges in the trace
+
+    @param[in]
+        event_type
+            edge event request type of the replayed line
+
+    @param[in]
+        initial
+            level of the line when it was requested
+
+    @param[in]
+        expected
+            number of bursts of edges in the trace, or 0 if unknown
+
+    @param[in]
+        gap
+            longest gap between the edges of a burst in nanoseconds
+
+    @retval 0 the trace was replayed
+    @retval 1 a debounce interval longer than the gap did not publish
+              the expected number of updates
+
+==============================================================================*/
+static int ReplayTrace( const char *name,
+                        LineEvent *pEvents,
+                        size_t n,
+                        int event_type,
+                        uint16_t initial,
+                        uint64_t expected,
+                        uint64_t gap )
+{
+    uint64_t interval;
+    uint64_t updates;
+    size_t i;
+    int result = 0;
+
+    printf( "\n%s: %zu edges", name, n );
+    if ( expected > 0 )
+    {
+        printf( ", %llu bursts", (unsigned long long)expected );
+    }
+
+    printf( "\n%12s %10s %10s %12s\n",
+            "debounce us", "updates", "debounced", "ns/edge" );
+
+    for ( i = 0; i < sizeof( intervals_us ) / sizeof( intervals_us[0] ); i++ )
+    {
+        interval = intervals_us[i] * NS_PER_US;
+        updates = Replay( pEvents, n, interval, event_type, initial );
+
+        if ( ( expected > 0 ) &&
+             ( interval > gap ) &&
+             ( updates != expected ) )
+        {
+            printf( "FAIL: %llu updates, expected %llu\n",
+                    (unsigned long long)updates,
+                    (unsigned long long)expected );
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Replay                                                                    */
+/*!
+    Replay a trace through the event handling
+
+    The Replay function passes each edge of the trace to the gpioctrl
+    event handling in timestamp order, and runs the event loop timers
+    which are due before each edge, as the event loop would.  With a
+    zero interval every edge is published, as for an input with the
+    event_publish attribute set to all.  Otherwise the edges are passed
+    to the userspace debounce filter, starting from the level which
+    RequestLine reads when the line is requested.  The number of variable
+    updates, the number of edges discarded by the filter, and the average
+    cost of handling an edge are printed.
+
+    @param[in]
+        pEvents
+            edges of the trace
+
+    @param[in]
+        n
+            number of edges in the trace
+
+    @param[in]
+        interval
+            debounce interval in nanoseconds, or 0 for no filter
+
+    @param[in]
+        event_type
+            edge event request type of the replayed line
+
+    @param[in]
+        initial
+            level of the line when it was requested
+
+    @retval number of variable updates published by the edges
+
+==============================================================================*/
+static uint64_t Replay( LineEvent *pEvents,
+                        size_t n,
+                        uint64_t interval,
+                        int event_type,
+                        uint16_t initial )
+{
+    GPIO gpio;
+    bool publish = false;
+    uint64_t start;
+    uint64_t end;
+    size_t i;
+
+    memset( &benchState, 0, sizeof( benchState ) );
+    benchState.eventQueue.arg = &benchState;
+
+    memset( &gpio, 0, sizeof( gpio ) );
+    gpio.hTimestampVar = VAR_INVALID;
+    gpio.inputMode = INPUT_MODE_LEVEL;
+    gpio.event_type = event_type;
+    gpio.publishAll = true;
+    gpio.debounceInterval = interval;
+    gpio.value = initial;
+    gpio.lineFd = -1;
+    TimerInit( &gpio.publishTimer, PublishTimer, &gpio );
+    TimerInit( &gpio.debounceTimer, DebounceTimer, &gpio );
+
+    start = GetMonotonicTime();
+
+    for ( i = 0; i < n; i++ )
+    {
+        /* run the timers which expired before the edge */
+        TimerDispatch( &benchState.eventQueue,
+                       pEvents[i].timestamp,
+                       pEvents[i].timestamp );
+
+        if ( interval > 0 )
+        {
+            DebounceEvent( &benchState, &gpio, &pEvents[i], &publish );
+        }
+        else
+        {
+            PublishValue( &benchState,
+                          &gpio,
+                          pEvents[i].level,
+                          pEvents[i].timestamp );
+        }
+    }
+
+    /* let the final edge settle */
+    TimerDispatch( &benchState.eventQueue, UINT64_MAX, UINT64_MAX );
+
+    end = GetMonotonicTime();
+
+    printf( "%12llu %10llu %10llu %12.1f\n",
+            (unsigned long long)( interval / NS_PER_US ),
+            (unsigned long long)benchState.stats.updates,
+            (unsigned long long)benchState.stats.debounced,
+            (double)( end - start ) / (double)n );
+
+    free( benchState.eventQueue.pTimers );
+
+    return benchState.stats.updates;
+}
+
+/*! @}
+ * end of bench_debounce group */
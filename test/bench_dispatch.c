@@ -0,0 +1,405 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup bench_dispatch bench_dispatch
+ * @brief GPIO dispatch table micro-benchmark
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file bench_dispatch.c
+
+    GPIO dispatch table micro-benchmark
+
+    The bench_dispatch application measures the cost of finding the GPIO
+    line associated with a variable handle, using the dispatch table built
+    by BuildGPIOTable, and using the linked list search it replaced.
+    Configurations of 1 to 1000 lines are spread across GPIO chips of
+    32 lines each.  No GPIO hardware or variable server is required.
+
+    The table lookup cost should stay flat as the number of lines grows,
+    while the list search cost grows with the number of lines.
+
+    Before the lookups are timed, the dispatch table is checked against
+    the list search for every handle up to beyond the largest one in use,
+    including the unused handles between the lines, VAR_INVALID, and a
+    handle far beyond the end of the table.  The benchmark fails if the
+    two ever find different lines.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <time.h>
+
+/* the benchmark calls the private functions of the gpioctrl service */
+#define main gpioctrl_main
+#include "../src/gpioctrl.c"
+#undef main
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of lines on each GPIO chip */
+#define BENCH_LINES_PER_CHIP    ( 32 )
+
+/*! number of lookups timed for each configuration */
+#define BENCH_LOOKUPS           ( 1000000 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! GPIO controller state used by the benchmark */
+static GPIOCtrlState benchState;
+
+/*! accumulates the lookup results so the lookups are not optimized out */
+static volatile uintptr_t sink;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int CreateBenchLines( GPIOCtrlState *pState, size_t n );
+static void FreeBenchLines( GPIOCtrlState *pState );
+static int CheckLookups( GPIOCtrlState *pState, size_t n );
+static double TimeLookups( GPIOCtrlState *pState, size_t n, bool table );
+static uint64_t BenchTime( void );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the dispatch table benchmark
+
+    The main function checks that the dispatch table lookup and the list
+    search agree, then times them for each configuration and prints the
+    cost of a lookup in nanoseconds.
+
+    @retval 0 the benchmark completed
+    @retval 1 the benchmark could not be set up, or the lookups disagreed
+
+==============================================================================*/
+int main( void )
+{
+    static const size_t sizes[] = { 1, 10, 100, 1000 };
+    double table;
+    double search;
+    size_t i;
+    int result = 0;
+
+    printf( "%8s %16s %16s\n", "lines", "table ns/lookup", "list ns/lookup" );
+
+    for ( i = 0; ( i < sizeof( sizes ) / sizeof( sizes[0] ) ); i++ )
+    {
+        memset( &benchState, 0, sizeof( benchState ) );
+
+        if ( ( CreateBenchLines( &benchState, sizes[i] ) != EOK ) ||
+             ( BuildGPIOTable( &benchState ) != EOK ) )
+        {
+            fprintf( stderr, "unable to create %zu lines\n", sizes[i] );
+            result = 1;
+        }
+        else if ( CheckLookups( &benchState, sizes[i] ) != EOK )
+        {
+            fprintf( stderr,
+                     "FAIL: the table and list lookups disagree "
+                     "for %zu lines\n",
+                     sizes[i] );
+            result = 1;
+        }
+        else
+        {
+            table = TimeLookups( &benchState, sizes[i], true );
+            search = TimeLookups( &benchState, sizes[i], false );
+
+            printf( "%8zu %16.2f %16.2f\n", sizes[i], table, search );
+        }
+
+        FreeBenchLines( &benchState );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CreateBenchLines                                                          */
+/*!
+    Create the GPIO lines of a benchmark configuration
+
+    The CreateBenchLines function creates the specified number of GPIO line
+    objects, with the odd variable handles 1 to 2n-1, on as many GPIO chips
+    as are needed to hold BENCH_LINES_PER_CHIP lines each.  The even
+    handles are left unused, so the dispatch table has gaps.  The lines
+    are not associated with any GPIO hardware.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state to add the lines to
+
+    @param[in]
+        n
+            number of lines to create
+
+    @retval EOK the lines were created
+    @retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int CreateBenchLines( GPIOCtrlState *pState, size_t n )
+{
+    int result = EOK;
+    GPIOChip *pGPIOChip = NULL;
+    GPIO *pGPIO;
+    size_t i;
+
+    for ( i = 0; ( i < n ) && ( result == EOK ); i++ )
+    {
+        if ( ( i % BENCH_LINES_PER_CHIP ) == 0 )
+        {
+            /* start a new GPIO chip */
+            pGPIOChip = calloc( 1, sizeof( GPIOChip ) );
+            if ( pGPIOChip != NULL )
+            {
+                if ( pState->pLastGPIOChip == NULL )
+                {
+                    pState->pFirstGPIOChip = pGPIOChip;
+                }
+                else
+                {
+                    pState->pLastGPIOChip->pNext = pGPIOChip;
+                }
+
+                pState->pLastGPIOChip = pGPIOChip;
+            }
+        }
+
+        pGPIO = calloc( 1, sizeof( GPIO ) );
+        if ( ( pGPIOChip != NULL ) &&
+             ( pGPIO != NULL ) )
+        {
+            pGPIO->hVar = (VAR_HANDLE)( 2 * i + 1 );
+            pGPIO->line_num = i % BENCH_LINES_PER_CHIP;
+
+            if ( pGPIOChip->pLastLine == NULL )
+            {
+                pGPIOChip->pFirstLine = pGPIO;
+            }
+            else
+            {
+                pGPIOChip->pLastLine->pNext = pGPIO;
+            }
+
+            pGPIOChip->pLastLine = pGPIO;
+        }
+        else
+        {
+            free( pGPIO );
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FreeBenchLines                                                            */
+/*!
+    Free the GPIO lines of a benchmark configuration
+
+    The FreeBenchLines function frees the GPIO chips and lines created by
+    CreateBenchLines, and the dispatch table.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state to free the lines of
+
+==============================================================================*/
+static void FreeBenchLines( GPIOCtrlState *pState )
+{
+    GPIOChip *pGPIOChip;
+    GPIO *pGPIO;
+    void *p;
+
+    pGPIOChip = pState->pFirstGPIOChip;
+    while ( pGPIOChip != NULL )
+    {
+        pGPIO = pGPIOChip->pFirstLine;
+        while ( pGPIO != NULL )
+        {
+            p = pGPIO;
+            pGPIO = pGPIO->pNext;
+            free( p );
+        }
+
+        p = pGPIOChip;
+        pGPIOChip = pGPIOChip->pNext;
+        free( p );
+    }
+
+    free( pState->pGPIOTable );
+
+    pState->pGPIOTable = NULL;
+    pState->nGPIOTable = 0;
+    pState->pFirstGPIOChip = NULL;
+    pState->pLastGPIOChip = NULL;
+}
+
+/*============================================================================*/
+/*  CheckLookups                                                              */
+/*!
+    Check the dispatch table against the list search
+
+    The CheckLookups function looks up every variable handle from
+    VAR_INVALID to two beyond the largest handle in use, and a handle far
+    beyond the end of the dispatch table, with both the dispatch table
+    and the list search.  Every handle must find the same line both ways,
+    and the handles in use must find the line which owns them.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state containing the lines
+
+    @param[in]
+        n
+            number of lines in the configuration
+
+    @retval EOK the lookups agreed
+    @retval EFAULT a handle found different lines
+
+==============================================================================*/
+static int CheckLookups( GPIOCtrlState *pState, size_t n )
+{
+    int result = EOK;
+    VAR_HANDLE hVar;
+    GPIO *pTable;
+    GPIO *pList;
+    size_t i;
+
+    for ( i = 0; i <= 2 * n + 2; i++ )
+    {
+        /* the last handle checked is far beyond the table */
+        hVar = ( i < 2 * n + 2 ) ? (VAR_HANDLE)i : (VAR_HANDLE)( 1000 * n );
+
+        pTable = FindGPIO( pState, hVar );
+        pList = SearchGPIO( pState, hVar );
+
+        if ( ( pTable != pList ) ||
+             ( ( pTable != NULL ) && ( pTable->hVar != hVar ) ) ||
+             ( ( pTable == NULL ) && ( i % 2 == 1 ) && ( i < 2 * n ) ) )
+        {
+            fprintf( stderr,
+                     "handle %llu: table %p, list %p\n",
+                     (unsigned long long)hVar,
+                     (void *)pTable,
+                     (void *)pList );
+            result = EFAULT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TimeLookups                                                               */
+/*!
+    Time the GPIO line lookups of a benchmark configuration
+
+    The TimeLookups function looks up BENCH_LOOKUPS pseudo-random variable
+    handles of the n lines, using either the dispatch table or the list
+    search, and calculates the average cost of a lookup.
+
+    @param[in]
+        pState
+            pointer to the GPIO controller state containing the lines
+
+    @param[in]
+        n
+            number of lines in the configuration
+
+    @param[in]
+        table
+            true to use the dispatch table, false to use the list search
+
+    @retval average cost of a lookup in nanoseconds
+
+==============================================================================*/
+static double TimeLookups( GPIOCtrlState *pState, size_t n, bool table )
+{
+    uint64_t start;
+    uint64_t end;
+    uint32_t seed = 1;
+    VAR_HANDLE hVar;
+    GPIO *pGPIO;
+    size_t i;
+
+    start = BenchTime();
+
+    for ( i = 0; i < BENCH_LOOKUPS; i++ )
+    {
+        /* linear congruential generator, so the lookups are not
+         * trivially predictable */
+        seed = seed * 1103515245u + 12345u;
+        hVar = (VAR_HANDLE)( 2 * ( ( seed >> 8 ) % n ) + 1 );
+
+        pGPIO = ( table == true ) ? FindGPIO( pState, hVar )
+                                  : SearchGPIO( pState, hVar );
+        sink += (uintptr_t)pGPIO;
+    }
+
+    end = BenchTime();
+
+    return (double)( end - start ) / (double)BENCH_LOOKUPS;
+}
+
+/*============================================================================*/
+/*  BenchTime                                                                 */
+/*!
+    Get the benchmark time
+
+    The BenchTime function reads the CLOCK_MONOTONIC clock used to time
+    the lookups.
+
+    @retval current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static uint64_t BenchTime( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*! @}
+ * end of bench_dispatch group */
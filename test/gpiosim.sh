@@ -0,0 +1,98 @@
+#!/bin/sh
+#
+# Helpers for the tests which run gpioctrl against a gpio-sim chip.
+# Source this file, then call sim_create with the number of lines.
+# The tests need root, the gpio-sim kernel module, and the varserver
+# tools, and exit with the ctest skip code 77 when any are missing.
+
+SIM_CONFIG=/sys/kernel/config/gpio-sim
+SIM_NAME=gpioctrl-test-$$
+SKIP=77
+
+# exit with the skip code and a reason
+skip() {
+    echo "SKIP: $*"
+    exit $SKIP
+}
+
+# check that a simulated chip can be created, and skip if it cannot
+sim_check_chip() {
+    [ "`id -u`" -eq 0 ] || skip "must be run as root"
+    [ -d $SIM_CONFIG ] || modprobe gpio-sim 2>/dev/null
+    [ -d $SIM_CONFIG ] || skip "gpio-sim is not available"
+}
+
+# check that the test can run, and skip it if it cannot
+sim_check() {
+    sim_check_chip
+    for tool in varserver varcreate getvar
+    do
+        command -v $tool >/dev/null || skip "$tool is not installed"
+    done
+    pgrep -x varserver >/dev/null && skip "a varserver is already running"
+}
+
+# create a live simulated chip with $1 lines, and set SIM_CHIP to its
+# gpiochip name and SIM_DEV to its platform device
+sim_create() {
+    mkdir $SIM_CONFIG/$SIM_NAME || return 1
+    mkdir $SIM_CONFIG/$SIM_NAME/bank0 || return 1
+    echo $1 > $SIM_CONFIG/$SIM_NAME/bank0/num_lines
+    echo 1 > $SIM_CONFIG/$SIM_NAME/live || return 1
+    SIM_CHIP=`cat $SIM_CONFIG/$SIM_NAME/bank0/chip_name`
+    SIM_DEV=`cat $SIM_CONFIG/$SIM_NAME/dev_name`
+    SIM_LINES=/sys/devices/platform/$SIM_DEV/$SIM_CHIP
+}
+
+# remove the simulated chip
+sim_remove() {
+    if [ -d $SIM_CONFIG/$SIM_NAME ]
+    then
+        echo 0 > $SIM_CONFIG/$SIM_NAME/live
+        rmdir $SIM_CONFIG/$SIM_NAME/bank0
+        rmdir $SIM_CONFIG/$SIM_NAME
+    fi
+}
+
+# drive simulated line $1 to level $2 by changing its pull
+sim_set() {
+    if [ $2 -eq 0 ]
+    then
+        echo pull-down > $SIM_LINES/sim_gpio$1/pull
+    else
+        echo pull-up > $SIM_LINES/sim_gpio$1/pull
+    fi
+}
+
+# write a varcreate file with $2 variables of type $3 named $1N to stdout
+sim_vars() {
+    echo '{ "vars" : ['
+    i=0
+    while [ $i -lt $2 ]
+    do
+        [ $i -gt 0 ] && echo ','
+        printf '    { "name" : "%s%d", "type" : "%s", "value" : "0" }' \
+            $1 $i $3
+        i=$((i+1))
+    done
+    echo
+    echo ']}'
+}
+
+# write a gpioctrl configuration to stdout for $2 lines of the simulated
+# chip, with variables named $1N, and the attributes in $3 on each line
+sim_config() {
+    echo '{ "gpiodef" : ['
+    echo "    { \"chip\" : \"$SIM_CHIP\","
+    echo '      "lines" : ['
+    i=0
+    while [ $i -lt $2 ]
+    do
+        [ $i -gt 0 ] && echo ','
+        printf '        { "line" : "%d", "var" : "%s%d", %s }' $i $1 $i "$3"
+        i=$((i+1))
+    done
+    echo
+    echo '    ]}'
+    echo ']}'
+}
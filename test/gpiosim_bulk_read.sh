@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Run the single and bulk read benchmark against 64 input lines of a
+# gpio-sim chip.  The odd lines are pulled up and the even lines pulled
+# down, so the benchmark can check that both read methods see the same
+# levels.
+#
+# usage: gpiosim_bulk_read.sh <bench_bulk_read> [snapshots]
+
+BENCH=$1
+SNAPSHOTS=${2:-10000}
+LINES=64
+
+. `dirname $0`/gpiosim.sh
+
+[ -x "$BENCH" ] || skip "usage: $0 <bench_bulk_read> [snapshots]"
+sim_check_chip
+
+trap sim_remove EXIT
+trap 'exit 1' INT TERM
+
+sim_create $LINES || { echo "FAIL: cannot create the gpio-sim chip"; exit 1; }
+
+line=0
+while [ $line -lt $LINES ]
+do
+    sim_set $line $((line%2))
+    line=$((line+1))
+done
+
+$BENCH $SIM_CHIP $SNAPSHOTS
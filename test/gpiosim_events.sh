@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+# Count the edges of 256 event inputs on a gpio-sim chip, and check that
+# gpioctrl counts every edge on every line.  Each round drives all of the
+# lines high and then all of them low, so each line sees two edges per
+# round while all 256 line event queues are being filled together.
+#
+# usage: gpiosim_events.sh <gpioctrl> [rounds]
+
+GPIOCTRL=$1
+ROUNDS=${2:-50}
+LINES=256
+VAR=/TEST/GPIOSIM/EVENTS/L
+
+. `dirname $0`/gpiosim.sh
+
+[ -x "$GPIOCTRL" ] || skip "usage: $0 <gpioctrl> [rounds]"
+sim_check
+
+TMP=`mktemp -d`
+cleanup() {
+    [ -n "$GPIOCTRL_PID" ] && kill $GPIOCTRL_PID 2>/dev/null
+    [ -n "$VARSERVER_PID" ] && kill $VARSERVER_PID 2>/dev/null
+    wait 2>/dev/null
+    sim_remove
+    rm -rf $TMP
+}
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+sim_create $LINES || { echo "FAIL: cannot create the gpio-sim chip"; exit 1; }
+
+sim_vars $VAR $LINES uint32 > $TMP/vars.json
+sim_config $VAR $LINES \
+    '"direction" : "counter", "event" : "BOTH_EDGES"' > $TMP/gpiocfg.json
+
+varserver &
+VARSERVER_PID=$!
+sleep 1
+varcreate $TMP/vars.json || { echo "FAIL: varcreate"; exit 1; }
+
+$GPIOCTRL -f $TMP/gpiocfg.json &
+GPIOCTRL_PID=$!
+sleep 1
+kill -0 $GPIOCTRL_PID 2>/dev/null || { echo "FAIL: gpioctrl exited"; exit 1; }
+
+round=0
+while [ $round -lt $ROUNDS ]
+do
+    for level in 1 0
+    do
+        line=0
+        while [ $line -lt $LINES ]
+        do
+            sim_set $line $level
+            line=$((line+1))
+        done
+    done
+    round=$((round+1))
+done
+
+# let gpioctrl drain the event queues
+sleep 1
+
+expected=$((ROUNDS*2))
+failed=0
+total=0
+line=0
+while [ $line -lt $LINES ]
+do
+    count=`getvar $VAR$line`
+    if [ "$count" != "$expected" ]
+    then
+        echo "line $line: counted $count edges, expected $expected"
+        failed=$((failed+1))
+    else
+        total=$((total+count))
+    fi
+    line=$((line+1))
+done
+
+echo "$LINES lines, $ROUNDS rounds, $total of $((LINES*expected)) edges counted"
+
+if [ $failed -ne 0 ]
+then
+    echo "FAIL: $failed lines lost events"
+    exit 1
+fi
+
+echo "PASS"
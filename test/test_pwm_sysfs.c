@@ -0,0 +1,437 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup test_pwm_sysfs test_pwm_sysfs
+ * @brief Hardware PWM backend test
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file test_pwm_sysfs.c
+
+    Hardware PWM backend test
+
+    The test_pwm_sysfs application tests the hardware PWM backend against
+    a fake sysfs pwmchip tree built in a temporary directory, so no PWM
+    hardware is required.  The location of the tree is passed to the
+    gpioctrl option processing with the -p option, in the same way as it
+    is passed to the gpioctrl service.
+
+    The test checks that a hardware PWM channel is configured with the
+    period, enable and duty cycle of its line, that the duty cycle follows
+    the line value, that a channel which is not exported is exported,
+    and that a missing PWM chip is reported.
+
+    Regular files do not behave like sysfs attributes, so the test
+    truncates each attribute before it is written, and the fake tree
+    does not create a channel directory when it is exported.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+/* the test calls the private functions of the gpioctrl service */
+#define main gpioctrl_main
+#include "../src/gpioctrl.c"
+#undef main
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! location of the fake sysfs pwmchip tree */
+static char sysfsRoot[] = "/tmp/gpioctrl-pwm-XXXXXX";
+
+/*! number of failed checks */
+static int failures;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int MakePath( char *path, size_t len, const char *dir, const char *name );
+static int CreateAttr( const char *dir, const char *attr );
+static void ReadAttr( const char *dir, const char *attr, char *buf, size_t len );
+static void ClearAttr( const char *dir, const char *attr );
+static void CheckAttr( const char *dir, const char *attr, const char *expected );
+static void Check( bool ok, const char *description );
+static void RemoveTree( void );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the hardware PWM backend test
+
+    The main function builds the fake sysfs pwmchip tree, runs the checks
+    and removes the tree.
+
+    @retval 0 all of the checks passed
+    @retval 1 one or more checks failed
+
+==============================================================================*/
+int main( void )
+{
+    char *argv[] = { "test_pwm_sysfs", "-p", sysfsRoot, NULL };
+    static char longRoot[PATH_MAX];
+    char chip[PATH_MAX];
+    char channel[PATH_MAX];
+    GPIO pwm;
+    GPIO unexported;
+    GPIO missing;
+    GPIO toolong;
+
+    if ( mkdtemp( sysfsRoot ) == NULL )
+    {
+        perror( "mkdtemp" );
+        return 1;
+    }
+
+    /* pwmchip0 has channel 0 exported, and channel 1 not exported */
+    Check( ( MakePath( chip, sizeof( chip ), sysfsRoot, "pwmchip0" ) == EOK ) &&
+           ( MakePath( channel, sizeof( channel ), chip, "pwm0" ) == EOK ) &&
+           ( mkdir( chip, 0755 ) == 0 ) &&
+           ( mkdir( channel, 0755 ) == 0 ) &&
+           ( CreateAttr( chip, "export" ) == EOK ) &&
+           ( CreateAttr( channel, "period" ) == EOK ) &&
+           ( CreateAttr( channel, "duty_cycle" ) == EOK ) &&
+           ( CreateAttr( channel, "enable" ) == EOK ),
+           "create the fake sysfs tree" );
+
+    /* pass the tree location as the gpioctrl service would get it */
+    memset( &state, 0, sizeof( state ) );
+    state.pPWMSysfs = PWM_SYSFS_ROOT;
+    ProcessOptions( 3, argv, &state );
+    Check( strcmp( state.pPWMSysfs, sysfsRoot ) == 0,
+           "-p sets the sysfs location" );
+
+    /* a 25 kHz, 8 bit hardware PWM line at half scale */
+    memset( &pwm, 0, sizeof( pwm ) );
+    pwm.PWM = true;
+    pwm.pwmBackend = PWM_BACKEND_HARDWARE;
+    pwm.pwmChip = 0;
+    pwm.pwmChannel = 0;
+    pwm.pwmPeriod = 40000;
+    pwm.pwmResolution = 8;
+    pwm.pwmMax = 255;
+    pwm.pwmDutyFd = -1;
+    pwm.value = 128;
+
+    Check( CreatePWM( &state, &pwm ) == EOK, "create the hardware PWM" );
+    Check( pwm.pwmHardware == true, "the line uses the hardware PWM" );
+    CheckAttr( channel, "period", "40000" );
+    CheckAttr( channel, "enable", "1" );
+    CheckAttr( channel, "duty_cycle", "20078" );
+
+    /* the duty cycle follows the line value */
+    ClearAttr( channel, "duty_cycle" );
+    pwm.value = 255;
+    Check( SetHardwarePWM( &pwm ) == EOK, "set full scale" );
+    CheckAttr( channel, "duty_cycle", "40000" );
+
+    ClearAttr( channel, "duty_cycle" );
+    pwm.value = 0;
+    Check( SetHardwarePWM( &pwm ) == EOK, "set zero" );
+    CheckAttr( channel, "duty_cycle", "0" );
+
+    /* a channel which is not exported is exported.  The fake tree
+     * does not create the channel, so the wait for it times out */
+    memset( &unexported, 0, sizeof( unexported ) );
+    unexported.pwmBackend = PWM_BACKEND_HARDWARE;
+    unexported.pwmChip = 0;
+    unexported.pwmChannel = 1;
+    unexported.pwmPeriod = 40000;
+    unexported.pwmMax = 255;
+    unexported.pwmDutyFd = -1;
+    Check( CreateHardwarePWM( &state, &unexported ) == ENOENT,
+           "an unexported channel times out" );
+    CheckAttr( chip, "export", "1" );
+
+    /* a missing PWM chip is reported */
+    memset( &missing, 0, sizeof( missing ) );
+    missing.pwmBackend = PWM_BACKEND_HARDWARE;
+    missing.pwmChip = 7;
+    missing.pwmDutyFd = -1;
+    Check( CreateHardwarePWM( &state, &missing ) == ENOENT,
+           "a missing chip is reported" );
+    Check( missing.pwmHardware == false, "a missing chip is not used" );
+
+    /* a sysfs root which leaves no room for the channel paths is
+     * rejected rather than truncated */
+    memset( longRoot, 'x', sizeof( longRoot ) - 8 );
+    longRoot[0] = '/';
+    state.pPWMSysfs = longRoot;
+    memset( &toolong, 0, sizeof( toolong ) );
+    toolong.pwmBackend = PWM_BACKEND_HARDWARE;
+    toolong.pwmDutyFd = -1;
+    Check( CreateHardwarePWM( &state, &toolong ) == ENAMETOOLONG,
+           "a sysfs root which is too long is reported" );
+    state.pPWMSysfs = sysfsRoot;
+
+    if ( pwm.pwmDutyFd != -1 )
+    {
+        close( pwm.pwmDutyFd );
+    }
+
+    RemoveTree();
+
+    printf( "%s\n", ( failures == 0 ) ? "PASS" : "FAIL" );
+
+    return ( failures == 0 ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  MakePath                                                                  */
+/*!
+    Build the path of a file in a fake sysfs directory
+
+    @param[out]
+        path
+            buffer to receive the path
+
+    @param[in]
+        len
+            size of the path buffer
+
+    @param[in]
+        dir
+            directory containing the file
+
+    @param[in]
+        name
+            name of the file
+
+    @retval EOK the path was built
+    @retval ENAMETOOLONG the path does not fit in the buffer
+
+==============================================================================*/
+static int MakePath( char *path, size_t len, const char *dir, const char *name )
+{
+    return ( (size_t)snprintf( path, len, "%s/%s", dir, name ) >= len )
+           ? ENAMETOOLONG
+           : EOK;
+}
+
+/*============================================================================*/
+/*  CreateAttr                                                                */
+/*!
+    Create an empty fake sysfs attribute
+
+    @param[in]
+        dir
+            directory to create the attribute in
+
+    @param[in]
+        attr
+            name of the attribute
+
+    @retval EOK the attribute was created
+    @retval other error creating the attribute
+
+==============================================================================*/
+static int CreateAttr( const char *dir, const char *attr )
+{
+    char path[PATH_MAX];
+    int result;
+    int fd;
+
+    result = MakePath( path, sizeof( path ), dir, attr );
+    if ( result == EOK )
+    {
+        fd = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        if ( fd != -1 )
+        {
+            close( fd );
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadAttr                                                                  */
+/*!
+    Read a fake sysfs attribute
+
+    @param[in]
+        dir
+            directory containing the attribute
+
+    @param[in]
+        attr
+            name of the attribute
+
+    @param[out]
+        buf
+            buffer to receive the NUL terminated attribute value
+
+    @param[in]
+        len
+            size of the buffer
+
+==============================================================================*/
+static void ReadAttr( const char *dir, const char *attr, char *buf, size_t len )
+{
+    char path[PATH_MAX];
+    ssize_t n = -1;
+    int fd;
+
+    if ( MakePath( path, sizeof( path ), dir, attr ) == EOK )
+    {
+        fd = open( path, O_RDONLY );
+        if ( fd != -1 )
+        {
+            n = read( fd, buf, len - 1 );
+            close( fd );
+        }
+    }
+
+    buf[( n > 0 ) ? n : 0] = '\0';
+}
+
+/*============================================================================*/
+/*  ClearAttr                                                                 */
+/*!
+    Clear a fake sysfs attribute before it is written
+
+    @param[in]
+        dir
+            directory containing the attribute
+
+    @param[in]
+        attr
+            name of the attribute
+
+==============================================================================*/
+static void ClearAttr( const char *dir, const char *attr )
+{
+    char path[PATH_MAX];
+
+    if ( MakePath( path, sizeof( path ), dir, attr ) == EOK )
+    {
+        (void)truncate( path, 0 );
+    }
+}
+
+/*============================================================================*/
+/*  CheckAttr                                                                 */
+/*!
+    Check the value of a fake sysfs attribute
+
+    @param[in]
+        dir
+            directory containing the attribute
+
+    @param[in]
+        attr
+            name of the attribute
+
+    @param[in]
+        expected
+            expected value of the attribute
+
+==============================================================================*/
+static void CheckAttr( const char *dir, const char *attr, const char *expected )
+{
+    char buf[64];
+    char description[BUFSIZ];
+
+    ReadAttr( dir, attr, buf, sizeof( buf ) );
+    snprintf( description,
+              sizeof( description ),
+              "%s is \"%s\" (got \"%s\")",
+              attr,
+              expected,
+              buf );
+
+    Check( strcmp( buf, expected ) == 0, description );
+}
+
+/*============================================================================*/
+/*  Check                                                                     */
+/*!
+    Report the result of a check
+
+    @param[in]
+        ok
+            true if the check passed
+
+    @param[in]
+        description
+            description of the check
+
+==============================================================================*/
+static void Check( bool ok, const char *description )
+{
+    printf( "%s: %s\n", ok ? "ok" : "FAILED", description );
+    if ( ok == false )
+    {
+        failures++;
+    }
+}
+
+/*============================================================================*/
+/*  RemoveTree                                                                */
+/*!
+    Remove the fake sysfs pwmchip tree
+
+==============================================================================*/
+static void RemoveTree( void )
+{
+    static const char *paths[] =
+    {
+        "pwmchip0/pwm0/period",
+        "pwmchip0/pwm0/duty_cycle",
+        "pwmchip0/pwm0/enable",
+        "pwmchip0/pwm0",
+        "pwmchip0/export",
+        "pwmchip0",
+        ""
+    };
+    char path[PATH_MAX];
+    size_t i;
+
+    for ( i = 0; i < sizeof( paths ) / sizeof( paths[0] ); i++ )
+    {
+        if ( MakePath( path, sizeof( path ), sysfsRoot, paths[i] ) == EOK )
+        {
+            (void)remove( path );
+        }
+    }
+}
+
+/*! @}
+ * end of test_pwm_sysfs group */